@@ -0,0 +1,48 @@
+#ifndef CALIB_PROFILE_H
+#define CALIB_PROFILE_H
+
+#include <stdint.h>
+
+#include "running_stats.h"
+
+/*file of the calibration profiles, little-endian*/
+#define CALIB_PROFILE_MAGIC "CWCP"
+#define CALIB_PROFILE_VERSION 1
+#define MAX_CALIB_PROFILES 64
+
+/*
+ * Reference of a player, as set by its last full training. A session starts
+ * from the stored profile of the player and only checks it on a few samples.
+ *
+ *   header:  magic[4], u16 version, u16 nb_features, u32 nb_profiles
+ *   profile: u32 id, u32 nb_samples, i64 trained_at, nb_features x (f64 mean, f64 std)
+ *   trailer: u32 FNV-1a of everything before
+ */
+typedef struct calib_profile_s{
+	
+	uint32_t id; /*player slot or player ID*/
+	uint32_t nb_samples; /*samples of the training*/
+	int64_t trained_at; /*seconds since the epoch*/
+	
+	int nb_features;
+	double mean[RUNNING_STATS_MAX_DIM];
+	double std_dev[RUNNING_STATS_MAX_DIM];
+	
+}calib_profile_t;
+
+typedef struct calib_profiles_s{
+	
+	int nb_features; /*of every profile in the set*/
+	int nb_profiles;
+	calib_profile_t profile[MAX_CALIB_PROFILES];
+	
+}calib_profiles_t;
+
+void calib_profiles_init(calib_profiles_t* profiles, int nb_features);
+int calib_profiles_load(calib_profiles_t* profiles, const char* filename);
+int calib_profiles_save(const calib_profiles_t* profiles, const char* filename);
+const calib_profile_t* calib_profiles_find(const calib_profiles_t* profiles, uint32_t id);
+int calib_profiles_store(calib_profiles_t* profiles, const calib_profile_t* profile);
+int calib_profile_verify(const calib_profile_t* profile, const running_stats_t* stats, double tolerance);
+
+#endif
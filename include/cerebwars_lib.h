@@ -1,13 +1,37 @@
 #ifndef CEREBWARS_LIB_H
 #define CEREBWARS_LIB_H
 
+#include <stdint.h>
+
+/*renderer modes*/
+#define RENDER_IDLE 0 /*strip turned off*/
+#define RENDER_TRAIN 1
+#define RENDER_PLAY 2
+#define RENDER_WINNER 3
+#define RENDER_ATTRACT 4 /*between games, at a low rate*/
+
+/*one-shot effects, played over the current mode*/
+#define EFFECT_FLASH 0
+#define EFFECT_COUNTDOWN 1 /*started with cerebral_wars_countdown*/
+
+int start_cerebral_wars_renderer();
+int stop_cerebral_wars_renderer();
+
 int start_cerebral_wars();
-int cerebral_wars_winner_mode();
+int cerebral_wars_winner_mode(int player);
+int cerebral_wars_countdown(int seconds);
 int cerebral_wars_training_mode();
+int cerebral_wars_attract_mode();
+int cerebral_wars_effect(int effect);
 void stop_cerebral_wars();
+int add_led_bus(char output_type, const char* target, int speed_hz, char encoding, double gamma, double brightness, int keep_alive_ms);
+int add_led_segment(int bus, int length, char reversed);
 
+void set_render_lag(int lag_ms);
+void set_render_seed(uint64_t seed);
 void set_player_rate(double rate, int player);
 void set_explosion_location(double relative_position);
+void publish_game_state();
 
 
 
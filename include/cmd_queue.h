@@ -0,0 +1,89 @@
+#ifndef CMD_QUEUE_H
+#define CMD_QUEUE_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define CMD_QUEUE_SIZE 16 /*power of 2*/
+
+/*
+ * Bounded command queue, from a single producer thread to a single consumer
+ * thread, without locks. The producer owns the head and the consumer owns 
+ * the tail, each publishes its index once the slot has been written or read.
+ * 
+ * producer:                         consumer:
+ *   cmd_queue_push(&queue, &cmd);     while(cmd_queue_pop(&queue, &cmd)){
+ *                                       ...execute cmd...
+ *                                     }
+ * 
+ * The consumer may sleep until a command is pushed, on the head as a futex word:
+ * cmd_queue_park gives the word and its value while the queue is empty, the 
+ * producer wakes it up if it is parked.
+ */
+typedef struct queue_cmd_s{
+	int type;
+	int arg;
+}queue_cmd_t;
+
+typedef struct cmd_queue_s{
+	queue_cmd_t cmds[CMD_QUEUE_SIZE];
+	uint32_t head __attribute__((aligned(64))); /*next slot to write*/
+	uint32_t tail __attribute__((aligned(64))); /*next slot to read*/
+	uint32_t parked; /*set while the consumer sleeps on head*/
+}cmd_queue_t;
+
+static inline void cmd_queue_init(cmd_queue_t* queue){
+	__atomic_store_n(&queue->head, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&queue->parked, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&queue->tail, 0, __ATOMIC_RELEASE);
+}
+
+/*returns 0 if the queue is full*/
+static inline int cmd_queue_push(cmd_queue_t* queue, const queue_cmd_t* cmd){
+	
+	uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	
+	if(head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) >= CMD_QUEUE_SIZE){
+		return 0;
+	}
+	
+	queue->cmds[head & (CMD_QUEUE_SIZE-1)] = *cmd;
+	__atomic_store_n(&queue->head, head+1, __ATOMIC_SEQ_CST);
+	
+	/*the consumer announced it sleeps, after checking head*/
+	if(__atomic_load_n(&queue->parked, __ATOMIC_SEQ_CST)){
+		syscall(SYS_futex, &queue->head, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+	return 1;
+}
+
+/*returns 0 if the queue is empty*/
+static inline int cmd_queue_pop(cmd_queue_t* queue, queue_cmd_t* cmd){
+	
+	uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	
+	if(tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE)){
+		return 0;
+	}
+	
+	*cmd = queue->cmds[tail & (CMD_QUEUE_SIZE-1)];
+	__atomic_store_n(&queue->tail, tail+1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*futex word to sleep on until a command is pushed, its value is *expected while empty*/
+static inline uint32_t* cmd_queue_park(cmd_queue_t* queue, uint32_t* expected){
+	
+	__atomic_store_n(&queue->parked, 1, __ATOMIC_SEQ_CST);
+	*expected = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	
+	return &queue->head;
+}
+
+static inline void cmd_queue_unpark(cmd_queue_t* queue){
+	__atomic_store_n(&queue->parked, 0, __ATOMIC_RELAXED);
+}
+
+#endif
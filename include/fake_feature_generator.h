@@ -13,8 +13,12 @@
 int fake_feat_gen_init(void *param);
 int fake_feat_gen_request(void *param);
 int fake_feat_gen_wait_for_request_completed(void *param);
+int fake_feat_gen_poll_request_completed(void *param);
 frame_info_t* fake_feat_gen_frame_info_ref(void *param);
 double* fake_feat_gen_feature_array_ref(void *param);
 int fake_feat_gen_cleanup(void *param);
 
+/*backend operations, for init_feature_input*/
+extern const feature_input_ops_t fake_feat_gen_ops;
+
 #endif
@@ -0,0 +1,42 @@
+#ifndef FEAT_PROC_WORKER_H
+#define FEAT_PROC_WORKER_H
+
+#include <pthread.h>
+
+#include "feature_processing.h"
+#include "feature_input_mux.h"
+
+/*worker modes*/
+#define WORKER_IDLE 0 /*inputs are left alone*/
+#define WORKER_TRAIN 1 /*train every player, then back to idle*/
+#define WORKER_SAMPLE 2 /*publish normalized samples continuously*/
+#define WORKER_EXIT 3
+
+/*
+ * Long-lived thread that drives the feature processing of every player,
+ * through the input mux. Samples are published in each player's feat_proc_t
+ * and read without blocking with get_published_sample.
+ */
+typedef struct feat_proc_worker_s{
+	
+	/*set when started*/
+	feature_input_mux_t* input_mux;
+	feat_proc_t* feature_proc; /*one per input of the mux*/
+	
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	
+	char mode; /*requested mode, see WORKER_* */
+	char busy; /*the worker is running a mode*/
+	int status; /*result of the last mode, EXIT_SUCCESS or EXIT_FAILURE*/
+	
+}feat_proc_worker_t;
+
+int start_feat_proc_worker(feat_proc_worker_t* worker, feature_input_mux_t* input_mux, feat_proc_t* feature_proc);
+int feat_proc_worker_train(feat_proc_worker_t* worker);
+int feat_proc_worker_sample(feat_proc_worker_t* worker);
+int feat_proc_worker_idle(feat_proc_worker_t* worker);
+int stop_feat_proc_worker(feat_proc_worker_t* worker);
+
+#endif
@@ -2,55 +2,100 @@
 #ifndef FEATURE_INPUT_H
 #define FEATURE_INPUT_H
 
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
 #include "feature_structure.h"
+#include "prng.h"
+
+/*returned by POLL_FEAT_FC while the requested page has not arrived*/
+#define FEAT_INPUT_PENDING 2
 
+/*dispatch macros, routed through the ops table of each feature input*/
 #define INIT_FEAT_INPUT_FC(param) \
-		_INIT_FEAT_INPUT_FC(param)
-		
+		((param)->ops->init(param))
+
 #define REQUEST_FEAT_FC(param) \
-		_REQUEST_FEAT_FC(param)
-		
+		((param)->ops->request(param))
+
 #define WAIT_FEAT_FC(param) \
-		_WAIT_FEAT_FC(param)
-		
+		((param)->ops->wait(param))
+
 #define GET_FRAME_INFO_FC(param) \
-		_GET_FRAME_INFO_FC(param)
-		
+		((param)->ops->get_frame_info(param))
+
 #define GET_FVECT_INFO_FC(param) \
-		_GET_FVECT_INFO_FC(param)
-		
-#define TERMINATE_FEAT_INPUT_FC() \
-		_TERMINATE_FEAT_INPUT_FC(NULL)
-		
-typedef int (*functionPtr_t) (void *);
-functionPtr_t _INIT_FEAT_INPUT_FC;
-functionPtr_t _REQUEST_FEAT_FC;
-functionPtr_t _WAIT_FEAT_FC;
-functionPtr_t _TERMINATE_FEAT_INPUT_FC;
+		((param)->ops->get_fvect_info(param))
+
+#define POLL_FEAT_FC(param) \
+		((param)->ops->poll(param))
+
+#define TERMINATE_FEAT_INPUT_FC(param) \
+		((param)->ops->terminate(param))
 
+typedef int (*functionPtr_t) (void *);
 typedef frame_info_t* (*get_frame_ptr_t) (void *);
 typedef double* (*get_fvect_ptr_t) (void *);
+typedef uint32_t* (*get_wait_word_t) (void *, uint32_t *);
 
-get_frame_ptr_t _GET_FRAME_INFO_FC;
-get_fvect_ptr_t _GET_FVECT_INFO_FC;
-
-//frame_info_t* shm_get_frame_info_ref(void *param);
-//double* shm_get_feature_array_ref(void *param);
+/*
+ * Operations implemented by a feature input backend (SHM, FAKE, ...).
+ * Each backend exposes one constant table, and each feature input
+ * holds a reference to the table of the backend it was initialized with.
+ */
+typedef struct feature_input_ops_s{
+	
+	const char* name; /*name of the backend, for reports*/
+	
+	functionPtr_t init;
+	functionPtr_t request;
+	functionPtr_t wait;
+	functionPtr_t poll; /*non-blocking wait, FEAT_INPUT_PENDING if not arrived*/
+	get_frame_ptr_t get_frame_info;
+	get_fvect_ptr_t get_fvect_info;
+	functionPtr_t terminate;
+	
+	/*optional (NULL), futex word to sleep on while pending, see feature_input_mux*/
+	get_wait_word_t park;
+	functionPtr_t unpark;
+	
+	/*optional (NULL), give back what the input holds and drop what arrived while unused*/
+	functionPtr_t release;
+	
+}feature_input_ops_t;
 
 
 typedef struct feature_input_s{
 	
+	/*set by init_feature_input, from the input type*/
+	const feature_input_ops_t* ops;
+	
 	/*options to be set for initialization*/
 	int shm_key;
 	int sem_key;
+	uint64_t seed; /*fake generator, seed of the run*/
+	uint32_t stream; /*fake generator, random stream of the input*/
 	
 	/*filled during initialization*/
 	int shmid; /*id of the shared memory array*/
 	char* shm_buf; /*pointer to the beginning of the shared buffer*/
 	int semid; /*id of semaphore set*/
 	struct sembuf *sops; /* pointer to operations to perform */
+	pthread_t sem_waiter; /*semaphore transport, takes the pages as they are written*/
+	uint32_t sem_arrived; /*semaphore transport, pages taken by the waiter, futex word*/
+	uint32_t sem_taken; /*semaphore transport, pages read*/
+	char sem_stop; /*semaphore transport, tells the waiter to return*/
+	char sem_failed; /*semaphore transport, the waiter failed*/
 	
 	int current_page; /*identification of the current page*/
+	char page_held; /*ring transport, a page is held by the reader*/
+	struct timespec ready_time; /*fake generator, time at which the sample arrives*/
+	prng_t prng; /*fake generator, draws the samples*/
+	
+	/*transport statistics, for benchmarking*/
+	unsigned int nb_pages; /*number of pages read*/
+	unsigned int nb_syscalls; /*number of system calls made to read them*/
 	
 	int nb_features; /*number of single features*/
 	int page_size; /*size of a single page*/
@@ -0,0 +1,55 @@
+#ifndef FEATURE_INPUT_MUX_H
+#define FEATURE_INPUT_MUX_H
+
+#include "feature_input.h"
+
+#define MUX_MAX_INPUTS 8
+
+/*sleep between polls, when the pending inputs can't all be waited on at once*/
+#define MUX_POLL_PERIOD_NS 5000000L
+
+/*returned by a mux handler*/
+#define MUX_INPUT_DONE 0 /*stop tracking the input*/
+#define MUX_INPUT_MORE 1 /*request another page on the input*/
+
+/*
+ * Handler called by the mux for each page that arrives,
+ * input_id is the index of the feature input in the mux.
+ */
+typedef int (*mux_handler_t)(int input_id, void *param);
+
+/*
+ * Lets a single thread wait on several feature inputs at once
+ * and dispatch each page as it arrives.
+ */
+typedef struct feature_input_mux_s{
+	
+	/*set during initialization*/
+	int nb_inputs;
+	feature_input_t* inputs[MUX_MAX_INPUTS];
+	
+	/*inputs that have been requested and not dispatched yet*/
+	char pending[MUX_MAX_INPUTS];
+	
+	/*futex_waitv is not supported by the kernel, poll instead*/
+	char no_waitv;
+	
+	/*set by feat_mux_interrupt, the mux returns instead of waiting*/
+	char interrupted;
+	uint32_t wake_word; /*futex word, changed on each interrupt*/
+	
+	/*statistics*/
+	unsigned int nb_dispatched; /*pages dispatched*/
+	unsigned int nb_sleeps; /*times the mux went to sleep*/
+	
+}feature_input_mux_t;
+
+int feat_mux_init(feature_input_mux_t* mux, feature_input_t* inputs, int nb_inputs);
+int feat_mux_request(feature_input_mux_t* mux, int input_id);
+int feat_mux_dispatch(feature_input_mux_t* mux, mux_handler_t handler, void *param);
+int feat_mux_run(feature_input_mux_t* mux, mux_handler_t handler, void *param);
+void feat_mux_release(feature_input_mux_t* mux);
+void feat_mux_interrupt(feature_input_mux_t* mux);
+void feat_mux_clear_interrupt(feature_input_mux_t* mux);
+
+#endif
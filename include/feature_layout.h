@@ -0,0 +1,47 @@
+#ifndef FEATURE_LAYOUT_H
+#define FEATURE_LAYOUT_H
+
+#include "xml.h"
+
+#define MAX_BAND_BINS 32 /*bins of a band, per channel*/
+
+/*
+ * Section of the feature vector, each channel has width features
+ * one after the other, starting at offset.
+ */
+typedef struct feature_section_s{
+	int offset; /*-1 if the section is not sent*/
+	int width; /*features per channel*/
+}feature_section_t;
+
+/*
+ * Layout of the feature vector, as configured. The sections follow each
+ * other in this order, only those selected are present.
+ */
+typedef struct feature_layout_s{
+	
+	int nb_channels;
+	int nb_features; /*length of the feature vector*/
+	double hz_per_bin; /*resolution of the FFT*/
+	
+	feature_section_t timeseries;
+	feature_section_t fft;
+	feature_section_t power_alpha;
+	feature_section_t power_beta;
+	feature_section_t power_gamma;
+	
+}feature_layout_t;
+
+/*
+ * Indices of the bins of a band of one channel in the feature vector, looked
+ * up once such that the band is gathered without computing any index.
+ */
+typedef struct band_gather_s{
+	int nb_bins;
+	int index[MAX_BAND_BINS];
+}band_gather_t;
+
+int init_feature_layout(feature_layout_t* layout, const appconfig_t* app_config);
+int feature_layout_band(const feature_layout_t* layout, int channel, double low_hz, double high_hz, band_gather_t* gather);
+
+#endif
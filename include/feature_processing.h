@@ -3,26 +3,75 @@
 
 #include "feature_structure.h"
 #include "feature_input.h"
+#include "seqlock.h"
+#include "running_stats.h"
+#include "calib_profile.h"
+#include "feature_layout.h"
 
+#define NB_CHANNELS_USED 2 /*features calibrated and normalized*/
+#define TRAIN_CONFIDENCE_Z 1.96 /*95% interval of the mean*/
+#define ADAPT_STD_RATIO 2.0 /*the adapted std stays within this factor of the trained one*/
 
 typedef struct feat_proc_s{
 	
 	/*to be set before init*/
-	int nb_train_samples;
+	int nb_train_samples; /*at most*/
+	int nb_min_train_samples; /*at least, before the estimates may be considered converged*/
+	double train_tolerance; /*relative half-width of the interval of the mean, 0 to disable*/
+	const calib_profile_t* baseline; /*stored profile of the player, verified instead of trained, can be NULL*/
+	int nb_verify_samples;
+	double verify_tolerance; /*largest shift of the mean, in standard deviations of the baseline*/
+	double adapt_half_life; /*samples, 0 keeps the reference of the training during the game*/
+	double adapt_gate; /*samples beyond this z-score, the player's effort, leave the reference alone*/
+	double adapt_max_drift; /*largest shift of the reference, in trained standard deviations*/
 	feature_input_t* feature_input;
+	const feature_layout_t* layout; /*of the feature vectors of the input*/
+	
+	/*bins of the band measured on each channel, set during init*/
+	band_gather_t band[NB_CHANNELS_USED];
+	
+	/*training state, set during init*/
+	int nb_packets_dropped;
+	char verifying; /*the samples are checked against the baseline*/
+	
+	/*statistics of the valid samples so far, updated with each one*/
+	/*read them with get_training_progress*/
+	seqlock_t train_lock;
+	running_stats_t train_stats;
 	
 	/*set during training*/
-	double mean[2];
-	double std_dev[2];
+	double mean[NB_CHANNELS_USED];
+	double std_dev[NB_CHANNELS_USED];
+	char warm_started; /*the reference is the baseline, verified*/
+	double trained_mean[NB_CHANNELS_USED];
+	double trained_std_dev[NB_CHANNELS_USED];
 	
-	/*current sample value, set during get_normalized_sample*/
+	/*reference adapted to the drift, with each sample*/
+	ewma_stats_t adapt_stats;
+	
+	/*current sample value and drift of the reference, published by normalize_sample_frame*/
+	/*read them with get_published_sample and get_reference_drift*/
+	seqlock_t sample_lock;
 	double sample;
+	unsigned int sample_nb; /*sequence number of the sample*/
+	double drift[NB_CHANNELS_USED]; /*shift of the reference, in trained standard deviations*/
+	double max_drift; /*largest shift of either feature so far*/
+	unsigned int nb_gated; /*samples that did not move the reference*/
 		
 }feat_proc_t; 
 
+/*returned by the per-frame processing functions*/
+#define FEAT_PROC_DONE 0 /*the frame completed the operation*/
+#define FEAT_PROC_MORE 1 /*another frame is required*/
+
 int init_feat_processing(feat_proc_t* feature_proc);
 void train_feat_processing(feat_proc_t* feature_proc);
+int train_feat_processing_frame(feat_proc_t* feature_proc);
 int get_normalized_sample(feat_proc_t* feature_proc);
+int normalize_sample_frame(feat_proc_t* feature_proc);
+unsigned int get_published_sample(feat_proc_t* feature_proc, double* sample);
+unsigned int get_training_progress(feat_proc_t* feature_proc, running_stats_t* stats);
+unsigned int get_reference_drift(feat_proc_t* feature_proc, double* drift, double* max_drift, unsigned int* nb_gated);
 int clean_up_feat_processing(feat_proc_t* feature_proc);
 
 #endif
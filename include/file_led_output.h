@@ -0,0 +1,36 @@
+#ifndef FILE_LED_OUTPUT_H
+#define FILE_LED_OUTPUT_H
+
+#include <stdint.h>
+
+#include "led_output.h"
+
+#define LED_LOG_MAGIC 0x474F4C4C /*"LLOG"*/
+#define LED_LOG_VERSION 1
+#define LED_LOG_NB_RECORDS 12000 /*a minute of frames, at 200 Hz*/
+
+/*a record is the monotonic time of the frame, in ns, followed by the frame*/
+#define LED_LOG_RECORD_SIZE(frame_size) (sizeof(uint64_t)+(frame_size))
+
+/*
+ * Header of the frame log. It is followed by LED_LOG_NB_RECORDS records, 
+ * frame n is in record n%nb_records, the log wraps around once full.
+ */
+typedef struct led_log_hdr_s{
+	
+	uint32_t magic;
+	uint32_t version;
+	uint32_t frame_size;
+	uint32_t nb_records;
+	uint64_t nb_frames; /*frames written since the log was created*/
+	
+}led_log_hdr_t;
+
+int file_led_output_open(void *param);
+int file_led_output_write(void *param, const void *frame, size_t size);
+int file_led_output_close(void *param);
+
+/*backend operations, for init_led_output*/
+extern const led_output_ops_t file_led_output_ops;
+
+#endif
@@ -3,7 +3,8 @@
 
 
 void setup_gpios(void);
-void wait_for_start_demo(void);
+char wait_for_start_demo(void);
+void cancel_wait_for_start_demo(void);
 
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef LED_ENCODER_H
+#define LED_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "led_strip.h"
+
+/*dispatch macro, routed through the encoder of each bus*/
+#define LED_ENCODE_FC(encoder, frame, nb_leds, wire) \
+		((encoder)->encode(encoder, frame, nb_leds, wire))
+
+/*APA102, 32 bits start frame, then a brightness byte before each pixel*/
+#define APA102_START_SIZE 4
+#define APA102_PIXEL_SIZE 4
+#define APA102_BRIGHTNESS_MARK 0xE0
+#define APA102_MAX_BRIGHTNESS 31
+
+/*WS2812 over SPI at 2.4 MHz, each bit is sent on 3 SPI bits (1: 110, 0: 100)*/
+#define WS2812_BITS_PER_BIT 3
+#define WS2812_CODE_SIZE WS2812_BITS_PER_BIT
+#define WS2812_RESET_SIZE 90 /*bytes held low to latch, 300us at 2.4 MHz*/
+#define WS2812_SPI_SPEED 2400000 /*Hz*/
+#define WS2812_SPI_SPEED_TOLERANCE 0.08 /*relative, about the timing tolerance of the chip*/
+
+typedef size_t (*led_encode_fc_t) (const void *, const pixel_t *, int, uint8_t *);
+
+/*
+ * Conversion of the frames rendered to the wire format of the LED chipset.
+ * The gamma and brightness correction, and the bit expansion of the WS2812,
+ * are folded into tables built once, such that each byte of the frame is
+ * encoded with a single table load.
+ */
+typedef struct led_encoder_s{
+	
+	const char* name; /*name of the wire format, for reports*/
+	led_encode_fc_t encode;
+	
+	uint8_t level[256]; /*corrected level of each channel value*/
+	uint8_t code[256][WS2812_CODE_SIZE]; /*WS2812, corrected level expanded on the wire*/
+	uint8_t global; /*APA102, brightness byte of each pixel*/
+	
+}led_encoder_t;
+
+int init_led_encoder(char encoding, double gamma, double brightness, led_encoder_t* encoder);
+size_t led_encoder_size(const led_encoder_t* encoder, int nb_leds);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef LED_LAYERS_H
+#define LED_LAYERS_H
+
+#include <stdint.h>
+
+#include "led_strip.h"
+
+/*
+ * Layer of the LED strip. Each part of the animation is painted in its own
+ * layer and the layers are added into the frame. A layer keeps the range of
+ * LEDs painted, it is black everywhere else, such that clearing it and adding
+ * it only cost the LEDs it covers.
+ *
+ *   frame = layer_begin(&layer, first, last); ...paint first to last...
+ *   layers_composite(layers, nb_layers, frame, nb_leds);
+ */
+typedef struct led_layer_s{
+	
+	pixel_t pixels[MAX_NB_LEDS];
+	int first; /*range painted, empty if first > last*/
+	int last;
+	
+}led_layer_t;
+
+void layer_init(led_layer_t* layer);
+pixel_t* layer_begin(led_layer_t* layer, int first, int last);
+void layer_clear(led_layer_t* layer);
+void layers_composite(const led_layer_t* layers, int nb_layers, pixel_t* frame, int nb_leds);
+void pixels_add_saturate(pixel_t* dest, const pixel_t* src, int nb_pixels);
+
+#endif
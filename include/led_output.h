@@ -0,0 +1,63 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LED_OUTPUT_TARGET_LENGTH 128
+
+/*dispatch macros, routed through the ops table of each LED output*/
+#define OPEN_LED_OUTPUT_FC(param) \
+		((param)->ops->open(param))
+
+#define WRITE_LED_OUTPUT_FC(param, frame, size) \
+		((param)->ops->write(param, frame, size))
+
+#define CLOSE_LED_OUTPUT_FC(param) \
+		((param)->ops->close(param))
+
+typedef int (*led_output_fc_t) (void *);
+typedef int (*led_output_write_t) (void *, const void *, size_t);
+
+/*
+ * Operations implemented by a LED output backend (SPI, NULL, UDP, ...).
+ * Each backend exposes one constant table, and each LED output holds a 
+ * reference to the table of the backend it was initialized with.
+ */
+typedef struct led_output_ops_s{
+	
+	const char* name; /*name of the backend, for reports*/
+	
+	led_output_fc_t open;
+	led_output_write_t write; /*sends one frame*/
+	led_output_fc_t close;
+	
+	/*the LEDs past the end of a shorter frame keep their color, such that
+	  a frame can be cut after its last LED that changed*/
+	char prefix_updates;
+	
+}led_output_ops_t;
+
+
+typedef struct led_output_s{
+	
+	/*set by init_led_output, from the output type*/
+	const led_output_ops_t* ops;
+	
+	/*options to be set for initialization*/
+	char target[LED_OUTPUT_TARGET_LENGTH]; /*device, file or host:port*/
+	size_t frame_size; /*size of a single frame*/
+	uint32_t speed_hz; /*SPI clock*/
+	long keep_alive_ns; /*longest time without a transfer, 0 to send every frame*/
+	
+	/*filled when opened*/
+	int fd; /*device, file or socket*/
+	char* buf; /*frames kept by the memory and file outputs*/
+	size_t buf_size;
+	unsigned long nb_frames; /*number of frames written*/
+	
+}led_output_t;
+
+int init_led_output(char output_type, const char* target, long keep_alive_ns, led_output_t* led_output);
+
+#endif
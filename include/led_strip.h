@@ -0,0 +1,42 @@
+#ifndef LED_STRIP_H
+#define LED_STRIP_H
+
+#include <stdint.h>
+
+/*longest strip, all the segments of the topology together*/
+#define MAX_NB_LEDS 4096
+
+/*direction in which the pixels of a segment move away from its entry*/
+#define SEGMENT_ASCENDING 1
+#define SEGMENT_DESCENDING -1
+
+typedef struct pixel_s{
+	
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+}pixel_t;
+
+/*
+ * Scrolling segment of the LED strip. New pixels are pushed at the entry of the
+ * segment and move away from it by one LED on each push. The segment is a ring 
+ * rotated by the pushes, so advancing it is O(1), whatever the strip length. 
+ * The ring is stored in strip order, such that it is copied to the frame 
+ * in at most two blocks.
+ */
+typedef struct strip_segment_s{
+	
+	pixel_t ring[MAX_NB_LEDS];
+	int length; /*number of LEDs in the ring*/
+	int head; /*ring index of the newest pixel*/
+	int direction; /*SEGMENT_ASCENDING or SEGMENT_DESCENDING*/
+	
+}strip_segment_t;
+
+void segment_init(strip_segment_t* segment, int direction, int length);
+void segment_push(strip_segment_t* segment, const pixel_t* pixel);
+void segment_render(const strip_segment_t* segment, pixel_t* frame, int entry, int first, int last);
+
+int frame_dirty_range(const pixel_t* previous, const pixel_t* frame, int nb_leds, int* first, int* last);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef LED_TOPOLOGY_H
+#define LED_TOPOLOGY_H
+
+#include <stdint.h>
+
+#include "led_strip.h"
+#include "led_output.h"
+#include "led_writer.h"
+#include "led_encoder.h"
+#include "xml.h"
+
+/*part of the strip wired to a bus, after the previous segments of the same bus*/
+typedef struct led_segment_map_s{
+	
+	int start; /*first LED, on the strip*/
+	int length; /*number of LEDs*/
+	int bus; /*index of the bus*/
+	int offset; /*first LED, on the bus*/
+	char reversed; /*wired from its last LED*/
+	
+}led_segment_map_t;
+
+/*LED output driven by its own writer thread*/
+typedef struct led_bus_s{
+	
+	led_output_t led_output;
+	led_encoder_t led_encoder;
+	led_writer_t writer;
+	int nb_leds; /*LEDs of all the segments of the bus*/
+	
+}led_bus_t;
+
+/*
+ * Layout of the LED strip. The game renders a single strip, which is split
+ * into segments, each wired to a bus. Each bus has its own output and writer
+ * thread, such that the transfers of the buses run in parallel.
+ */
+typedef struct led_topology_s{
+	
+	int nb_leds; /*length of the strip, all the segments together*/
+	
+	int nb_buses;
+	led_bus_t bus[MAX_LED_BUSES];
+	
+	int nb_segments;
+	led_segment_map_t segment[MAX_LED_SEGMENTS];
+	
+}led_topology_t;
+
+int led_topology_add_bus(led_topology_t* topology, char output_type, const char* target, uint32_t speed_hz, char encoding, double gamma, double brightness, long keep_alive_ns);
+int led_topology_add_segment(led_topology_t* topology, int bus, int length, char reversed);
+int start_led_topology(led_topology_t* topology, double rate_hz);
+void led_topology_present(led_topology_t* topology, const pixel_t* strip);
+void led_topology_set_idle(led_topology_t* topology, char idle);
+int stop_led_topology(led_topology_t* topology);
+
+#endif
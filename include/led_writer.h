@@ -0,0 +1,76 @@
+#ifndef LED_WRITER_H
+#define LED_WRITER_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "led_strip.h"
+#include "led_output.h"
+#include "led_encoder.h"
+#include "tick_scheduler.h"
+
+/*back buffer of the renderer, latest frame and frame being sent*/
+#define LED_WRITER_NB_FRAMES 3
+
+/*set on the latest frame index while it hasn't been taken by the writer*/
+#define LED_FRAME_FRESH 0x04
+#define LED_FRAME_IDX_MASK 0x03
+
+#define LED_WRITER_NAME_LENGTH (LED_OUTPUT_TARGET_LENGTH+16)
+
+/*tick rate while idle, for the keep-alive, frames published are sent right away*/
+#define LED_WRITER_IDLE_RATE 10.0
+
+/*
+ * Output thread of the LED strip. The renderer fills the back buffer and 
+ * publishes it with led_writer_swap, which never blocks. The writer thread
+ * takes the latest frame published and sends it to the LED output, at a fixed rate.
+ * Frames are exchanged through an atomic index, such that the renderer never
+ * waits on a transfer and the writer never sends a frame being rendered.
+ * While idle, the writer sleeps on that index instead, until a frame is published.
+ */
+typedef struct led_writer_s{
+	
+	/*set when started*/
+	led_output_t* led_output;
+	const led_encoder_t* led_encoder;
+	tick_scheduler_t sched;
+	double rate_hz; /*frame rate, while not idle*/
+	int nb_leds; /*length of the frames*/
+	char name[LED_WRITER_NAME_LENGTH]; /*for reports*/
+	
+	pthread_t thread;
+	char alive;
+	char idle; /*requested by the renderer*/
+	char idling; /*owned by the writer thread*/
+	uint32_t parked; /*set while the writer sleeps on latest*/
+	
+	pixel_t* frames[LED_WRITER_NB_FRAMES];
+	int back; /*owned by the renderer*/
+	int front; /*owned by the writer thread*/
+	uint32_t latest; /*index of the latest frame published, with LED_FRAME_FRESH*/
+	
+	/*frame diffing, owned by the writer thread*/
+	pixel_t* sent; /*what the strip shows*/
+	uint8_t* wire; /*frame being sent, in the wire format*/
+	struct timespec last_sent; /*time of the last transfer*/
+	
+	/*statistics*/
+	unsigned long nb_published; /*frames published by the renderer*/
+	unsigned long nb_dropped; /*frames replaced before being sent*/
+	unsigned long nb_sent; /*transfers*/
+	unsigned long nb_repeated; /*ticks without a new frame, the renderer was late*/
+	unsigned long nb_unchanged; /*transfers skipped, the frame didn't change*/
+	double total_bytes; /*total bytes sent*/
+	long max_transfer_ns; /*longest transfer*/
+	double total_transfer_ns; /*total time spent in transfers*/
+	
+}led_writer_t;
+
+int start_led_writer(led_writer_t* writer, led_output_t* led_output, const led_encoder_t* led_encoder, int nb_leds, double rate_hz);
+pixel_t* led_writer_back(led_writer_t* writer);
+void led_writer_swap(led_writer_t* writer);
+void led_writer_set_idle(led_writer_t* writer, char idle);
+int stop_led_writer(led_writer_t* writer);
+
+#endif
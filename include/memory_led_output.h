@@ -0,0 +1,16 @@
+#ifndef MEMORY_LED_OUTPUT_H
+#define MEMORY_LED_OUTPUT_H
+
+#include "led_output.h"
+
+#define LED_MEMORY_NB_FRAMES 256 /*frames kept in the ring*/
+
+int memory_led_output_open(void *param);
+int memory_led_output_write(void *param, const void *frame, size_t size);
+int memory_led_output_close(void *param);
+const void* memory_led_output_frame(const led_output_t* led_output, unsigned long frame_nb);
+
+/*backend operations, for init_led_output*/
+extern const led_output_ops_t memory_led_output_ops;
+
+#endif
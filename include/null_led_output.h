@@ -0,0 +1,13 @@
+#ifndef NULL_LED_OUTPUT_H
+#define NULL_LED_OUTPUT_H
+
+#include "led_output.h"
+
+int null_led_output_open(void *param);
+int null_led_output_write(void *param, const void *frame, size_t size);
+int null_led_output_close(void *param);
+
+/*backend operations, for init_led_output*/
+extern const led_output_ops_t null_led_output_ops;
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <stdint.h>
+
+#include "led_strip.h"
+
+#define PARTICLE_LENGTH 4 /*head and tail, in LEDs*/
+
+/*positions and speeds are in LEDs, Q16 fixed point*/
+#define Q16_SHIFT 16
+#define Q16_ONE (1<<Q16_SHIFT)
+#define INT_TO_Q16(x) ((int32_t)(x)<<Q16_SHIFT)
+#define Q16_TO_INT(x) ((x)>>Q16_SHIFT) /*floor*/
+
+/*the fractional part of the position is rendered on this many steps*/
+#define SUBPIXEL_BITS 5
+#define SUBPIXEL_STEPS (1<<SUBPIXEL_BITS)
+
+/*particles are spaced by at least their length, on each side*/
+#define MAX_PARTICLES (MAX_NB_LEDS/PARTICLE_LENGTH+1)
+
+/*
+ * Particles of one player, stored as a structure of arrays. Particles enter
+ * at the entry LED and move in the direction of the list, the head first.
+ * They are removed once they have completely left the visible range.
+ * Positions are kept in fixed point, a particle in between two LEDs spreads 
+ * its brightness over both of them.
+ */
+typedef struct particle_list_s{
+	
+	/*set during init*/
+	int entry; /*LED where particles are spawned*/
+	int direction; /*SEGMENT_ASCENDING or SEGMENT_DESCENDING*/
+	pixel_t color; /*color of the particles at full intensity*/
+	
+	/*LEDs where the particles can be seen, set when advanced*/
+	int first;
+	int last;
+	
+	/*particles*/
+	int nb_particles;
+	int32_t position[MAX_PARTICLES]; /*LED of the head, Q16*/
+	int32_t speed[MAX_PARTICLES]; /*LEDs per frame, Q16*/
+	uint8_t intensity[MAX_PARTICLES];
+	uint32_t age[MAX_PARTICLES]; /*frames since spawned*/
+	
+}particle_list_t;
+
+void particles_init(particle_list_t* list, int entry, int direction, const pixel_t* color, int nb_leds);
+int particles_spawn(particle_list_t* list, int32_t speed, uint8_t intensity);
+char particles_entry_clear(const particle_list_t* list);
+void particles_advance(particle_list_t* list, int first, int last);
+char particles_in_range(const particle_list_t* list, int low, int high);
+void particles_rasterize(const particle_list_t* list, pixel_t* frame);
+
+#endif
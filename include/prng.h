@@ -0,0 +1,100 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+/*threshold under which a draw of prng_next falls with the given probability*/
+#define PRNG_CHANCE(p) ((uint32_t)((p)*4294967295.0))
+
+/*
+ * Pseudo-random generator, xoshiro128**. Each thread owns its own state,
+ * so drawing takes no lock, unlike rand(). A state is seeded from the seed
+ * of the run and a stream number, such that the threads draw different
+ * sequences and a run is reproduced by reusing its seed.
+ *
+ *   prng_seed(&prng, seed, stream);
+ *   if(prng_next(&prng) < PRNG_CHANCE(0.25)){ ...one time out of four... }
+ */
+typedef struct prng_s{
+	uint32_t s[4];
+}prng_t;
+
+static inline uint64_t prng_splitmix64(uint64_t* x){
+	
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+	
+	z = (z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+	z = (z^(z>>27))*0x94D049BB133111EBULL;
+	return z^(z>>31);
+}
+
+static inline void prng_seed(prng_t* prng, uint64_t seed, uint32_t stream){
+	
+	uint64_t x = seed^((uint64_t)stream*0xD1B54A32D192ED03ULL);
+	uint64_t z;
+	
+	z = prng_splitmix64(&x);
+	prng->s[0] = (uint32_t)z;
+	prng->s[1] = (uint32_t)(z>>32);
+	z = prng_splitmix64(&x);
+	prng->s[2] = (uint32_t)z;
+	prng->s[3] = (uint32_t)(z>>32);
+	
+	/*the all zero state never leaves zero*/
+	if((prng->s[0]|prng->s[1]|prng->s[2]|prng->s[3]) == 0){
+		prng->s[0] = 1;
+	}
+}
+
+static inline uint32_t prng_rotl(uint32_t x, int k){
+	return (x<<k)|(x>>(32-k));
+}
+
+static inline uint32_t prng_next(prng_t* prng){
+	
+	uint32_t result = prng_rotl(prng->s[1]*5, 7)*9;
+	uint32_t t = prng->s[1]<<9;
+	
+	prng->s[2] ^= prng->s[0];
+	prng->s[3] ^= prng->s[1];
+	prng->s[1] ^= prng->s[2];
+	prng->s[0] ^= prng->s[3];
+	prng->s[2] ^= t;
+	prng->s[3] = prng_rotl(prng->s[3], 11);
+	
+	return result;
+}
+
+/*uniform in [0,1)*/
+static inline double prng_uniform(prng_t* prng){
+	return prng_next(prng)*(1.0/4294967296.0);
+}
+
+/*n uniform values in [0,1), the state is kept in registers for the whole batch*/
+static inline void prng_uniform_batch(prng_t* prng, double* values, int n){
+	
+	prng_t local = *prng;
+	int i;
+	
+	for(i=0;i<n;i++){
+		values[i] = prng_uniform(&local);
+	}
+	
+	*prng = local;
+}
+
+/*seed of a run without one configured, from the time and the process*/
+static inline uint64_t prng_entropy_seed(){
+	
+	struct timespec now;
+	uint64_t x;
+	
+	clock_gettime(CLOCK_REALTIME, &now);
+	x = ((uint64_t)now.tv_sec*1000000000ULL+now.tv_nsec)^((uint64_t)getpid()<<32);
+	
+	return prng_splitmix64(&x);
+}
+
+#endif
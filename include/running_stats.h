@@ -0,0 +1,105 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <math.h>
+
+#define RUNNING_STATS_MAX_DIM 8 /*features accumulated at once*/
+
+/*
+ * Running mean and variance of a vector of features, updated one sample at a
+ * time with Welford's method. Nothing is buffered, the statistics are exact
+ * after each sample and numerically stable over long series.
+ *
+ *   running_stats_init(&stats, nb_features);
+ *   running_stats_add(&stats, features); ...
+ *   mean = stats.mean[k]; std = running_stats_std(&stats, k);
+ *   converged = running_stats_mean_ci(&stats, k, 1.96) <= tolerance*fabs(mean);
+ */
+typedef struct running_stats_s{
+	int dim; /*number of features*/
+	unsigned int n; /*samples accumulated*/
+	double mean[RUNNING_STATS_MAX_DIM];
+	double m2[RUNNING_STATS_MAX_DIM]; /*sum of the squared deviations from the mean*/
+}running_stats_t;
+
+static inline void running_stats_init(running_stats_t* stats, int dim){
+
+	int k;
+
+	stats->dim = dim<RUNNING_STATS_MAX_DIM?dim:RUNNING_STATS_MAX_DIM;
+	stats->n = 0;
+	for(k=0;k<RUNNING_STATS_MAX_DIM;k++){
+		stats->mean[k] = 0.0;
+		stats->m2[k] = 0.0;
+	}
+}
+
+static inline void running_stats_add(running_stats_t* stats, const double* x){
+
+	double delta;
+	int k;
+
+	stats->n++;
+	for(k=0;k<stats->dim;k++){
+		delta = x[k]-stats->mean[k];
+		stats->mean[k] += delta/stats->n;
+		stats->m2[k] += delta*(x[k]-stats->mean[k]);
+	}
+}
+
+/*sample variance, 0 until two samples are in*/
+static inline double running_stats_var(const running_stats_t* stats, int k){
+	return stats->n>1?stats->m2[k]/(stats->n-1):0.0;
+}
+
+static inline double running_stats_std(const running_stats_t* stats, int k){
+	return sqrt(running_stats_var(stats, k));
+}
+
+/*half-width of the confidence interval of the mean, z is the normal quantile (1.96 for 95%)*/
+static inline double running_stats_mean_ci(const running_stats_t* stats, int k, double z){
+	return stats->n>1?z*running_stats_std(stats, k)/sqrt((double)stats->n):INFINITY;
+}
+
+/*
+ * Exponentially weighted mean and variance, the weight of a sample halves
+ * every half_life samples after it. The statistics follow a slow drift of the
+ * features, each update is O(1).
+ *
+ *   ewma_stats_init(&stats, nb_features, half_life, mean, var);
+ *   ewma_stats_add(&stats, features); ...
+ */
+typedef struct ewma_stats_s{
+	int dim; /*number of features*/
+	double alpha; /*weight of a new sample*/
+	double mean[RUNNING_STATS_MAX_DIM];
+	double var[RUNNING_STATS_MAX_DIM];
+}ewma_stats_t;
+
+static inline void ewma_stats_init(ewma_stats_t* stats, int dim, double half_life, const double* mean, const double* var){
+
+	int k;
+
+	stats->dim = dim<RUNNING_STATS_MAX_DIM?dim:RUNNING_STATS_MAX_DIM;
+	stats->alpha = half_life>0.0?1.0-exp2(-1.0/half_life):1.0;
+	for(k=0;k<stats->dim;k++){
+		stats->mean[k] = mean[k];
+		stats->var[k] = var[k];
+	}
+}
+
+static inline void ewma_stats_add(ewma_stats_t* stats, const double* x){
+
+	double delta;
+	double increment;
+	int k;
+
+	for(k=0;k<stats->dim;k++){
+		delta = x[k]-stats->mean[k];
+		increment = stats->alpha*delta;
+		stats->mean[k] += increment;
+		stats->var[k] = (1.0-stats->alpha)*(stats->var[k]+delta*increment);
+	}
+}
+
+#endif
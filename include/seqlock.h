@@ -0,0 +1,54 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+
+/*
+ * Sequence lock, publishes a small structure from a single writer to
+ * any number of readers without blocking either side. The writer makes
+ * the sequence odd while it updates the data, readers retry if the 
+ * sequence was odd or has changed during their copy.
+ * 
+ * writer:                           reader:
+ *   seqlock_write_begin(&lock);       do{
+ *   ...update data...                   seq = seqlock_read_begin(&lock);
+ *   seqlock_write_end(&lock);           ...copy data...
+ *                                     }while(seqlock_read_retry(&lock, seq));
+ */
+typedef struct seqlock_s{
+	uint32_t seq;
+}seqlock_t;
+
+#define SEQLOCK_INIT {0}
+
+static inline void seqlock_init(seqlock_t* lock){
+	__atomic_store_n(&lock->seq, 0, __ATOMIC_RELEASE);
+}
+
+static inline void seqlock_write_begin(seqlock_t* lock){
+	__atomic_store_n(&lock->seq, lock->seq+1, __ATOMIC_RELAXED);
+	/*the odd sequence must be visible before the data changes*/
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void seqlock_write_end(seqlock_t* lock){
+	__atomic_store_n(&lock->seq, lock->seq+1, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t seqlock_read_begin(const seqlock_t* lock){
+	
+	uint32_t seq;
+	
+	/*wait for the writer to be done, it only holds it for a copy*/
+	while((seq = __atomic_load_n(&lock->seq, __ATOMIC_ACQUIRE)) & 1);
+	
+	return seq;
+}
+
+static inline int seqlock_read_retry(const seqlock_t* lock, uint32_t seq){
+	/*the data must be read before the sequence is checked again*/
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&lock->seq, __ATOMIC_RELAXED) != seq;
+}
+
+#endif
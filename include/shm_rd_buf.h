@@ -15,7 +15,10 @@
  *        dropping newest...
  */
  
+#include <stdint.h>
+
 #include "feature_structure.h"
+#include "feature_input.h"
 
 //#define NB_FEATURES 220
 //#define FEATURE_SIZE 8 
@@ -38,12 +41,85 @@
 #define INTERFACE_CONNECTED 5 //sem posted when interface connection established
 /**/
 
+/*
+ * A SysV semaphore can't be waited on along with other inputs, so a waiter
+ * thread blocks on PREPROC_OUT_READY and counts the pages written in a futex
+ * word (sem_arrived), which the mux sleeps on. It only wakes for a page, or
+ * when the input is terminated, which posts the semaphore once more.
+ */
+#define SHM_WAITER_FAILED 0x80000000u /*set in sem_arrived when the waiter failed*/
+
+/*
+ * Ring transport (SHM_RING)
+ * 
+ * Alternative to the semaphore protocol above, the shared memory starts with
+ * a header page followed by buffer_depth pages. The header holds two free running
+ * counters: head, the number of pages published by the writer, and tail, the
+ * number of pages released by the reader. Page n is located at n%buffer_depth.
+ * 
+ * writer: if head-tail < buffer_depth, fill page head%buffer_depth, then
+ *         increment head with a seq_cst read-modify-write (__atomic_fetch_add)
+ *         and if reader_parked is set, FUTEX_WAKE head. Otherwise, the sample
+ *         is dropped.
+ * reader: holds page tail%buffer_depth while head != tail, increment tail (release)
+ *         to give it back. When empty, it sets reader_parked, issues a full fence
+ *         and FUTEX_WAIT on head.
+ * 
+ * Each side stores one word then loads the other's. A release store followed by
+ * a load may be reordered, and the writer would then see reader_parked clear
+ * while the reader sees the old head and sleeps, missing the wakeup. The seq_cst
+ * RMW on head (or a full fence between storing head and loading reader_parked)
+ * and the reader's fence make at least one of them see the other's store.
+ * 
+ * The reader (this process) initializes the header if it is not already set.
+ */
+#define SHM_RING_MAGIC 0x47524243 /*"CBRG"*/
+#define SHM_RING_VERSION 1
+#define SHM_RING_HDR_SIZE 4096
+#define SHM_RING_CACHE_LINE 64
+
+typedef struct shm_ring_hdr_s{
+	
+	/*geometry, set once by the reader*/
+	uint32_t magic;
+	uint32_t version;
+	uint32_t page_size;
+	uint32_t buffer_depth;
+	
+	/*writer side*/
+	uint32_t head __attribute__((aligned(SHM_RING_CACHE_LINE))); /*pages published, futex word*/
+	uint32_t nb_dropped; /*samples dropped because the ring was full*/
+	
+	/*reader side*/
+	uint32_t tail __attribute__((aligned(SHM_RING_CACHE_LINE))); /*pages released*/
+	uint32_t reader_parked; /*set while the reader sleeps on head*/
+	
+}shm_ring_hdr_t;
+
 int shm_rd_init(void *param);
 int shm_rd_request(void *param);
 int shm_rd_wait_for_request_completed(void *param);
+int shm_rd_poll_request_completed(void *param);
+uint32_t* shm_rd_park(void *param, uint32_t *expected);
+int shm_rd_unpark(void *param);
 frame_info_t* shm_get_frame_info_ref(void *param);
 double* shm_get_feature_array_ref(void *param);
 int shm_rd_cleanup(void *param);
 
+int shm_ring_init(void *param);
+int shm_ring_request(void *param);
+int shm_ring_wait_for_request_completed(void *param);
+int shm_ring_poll_request_completed(void *param);
+uint32_t* shm_ring_park(void *param, uint32_t *expected);
+int shm_ring_unpark(void *param);
+int shm_ring_release(void *param);
+frame_info_t* shm_ring_get_frame_info_ref(void *param);
+double* shm_ring_get_feature_array_ref(void *param);
+int shm_ring_cleanup(void *param);
+
+/*backend operations, for init_feature_input*/
+extern const feature_input_ops_t shm_rd_ops;
+extern const feature_input_ops_t shm_ring_ops;
+
 
 #endif
@@ -0,0 +1,13 @@
+#ifndef SPI_LED_OUTPUT_H
+#define SPI_LED_OUTPUT_H
+
+#include "led_output.h"
+
+int spi_led_output_open(void *param);
+int spi_led_output_write(void *param, const void *frame, size_t size);
+int spi_led_output_close(void *param);
+
+/*backend operations, for init_led_output*/
+extern const led_output_ops_t spi_led_output_ops;
+
+#endif
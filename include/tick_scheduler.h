@@ -0,0 +1,40 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Fixed-rate scheduler on the monotonic clock. Each tick starts on an absolute
+ * deadline, so the rate doesn't drift with the work done in the ticks. The
+ * time spent working in each tick is tracked against the tick period.
+ */
+typedef struct tick_scheduler_s{
+	
+	long period_ns; /*tick period*/
+	
+	struct timespec start; /*time of the first tick*/
+	struct timespec next; /*deadline of the next tick*/
+	struct timespec tick_start; /*time at which the current tick started*/
+	
+	/*statistics*/
+	unsigned long nb_ticks; /*ticks executed*/
+	unsigned long nb_events; /*ticks started early by an event, see tick_scheduler_wait_on*/
+	unsigned long nb_overruns; /*ticks whose work went over the period*/
+	unsigned long nb_skipped; /*deadlines skipped to catch up after an overrun*/
+	long max_work_ns; /*longest tick*/
+	double total_work_ns; /*total time spent working in ticks*/
+	
+}tick_scheduler_t;
+
+int tick_scheduler_init(tick_scheduler_t* sched, double rate_hz);
+int tick_scheduler_wait(tick_scheduler_t* sched);
+int tick_scheduler_wait_on(tick_scheduler_t* sched, uint32_t* word, uint32_t expected);
+int tick_scheduler_set_rate(tick_scheduler_t* sched, double rate_hz);
+double tick_scheduler_elapsed(tick_scheduler_t* sched);
+void tick_scheduler_report(tick_scheduler_t* sched, const char* name);
+
+void timespec_add_ns(struct timespec* t, long long ns);
+long long timespec_diff_ns(const struct timespec* a, const struct timespec* b);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef UDP_LED_OUTPUT_H
+#define UDP_LED_OUTPUT_H
+
+#include "led_output.h"
+
+/*
+ * A frame is split in datagrams that fit an Ethernet MTU over IPv6, such that
+ * none is fragmented. Each starts with a header, in network byte order:
+ * 
+ *   u32 frame number, u32 offset of the payload in the frame, u32 size of the frame
+ * 
+ * The controller shows a frame once it has all of its bytes, and drops the
+ * datagrams of a frame older than the one it is assembling.
+ */
+#define UDP_LED_HEADER_SIZE 12
+#define UDP_LED_MAX_PAYLOAD 1440 /*1500-40 (IPv6)-8 (UDP)-header*/
+
+int udp_led_output_open(void *param);
+int udp_led_output_write(void *param, const void *frame, size_t size);
+int udp_led_output_close(void *param);
+
+/*backend operations, for init_led_output*/
+extern const led_output_ops_t udp_led_output_ops;
+
+#endif
@@ -11,22 +11,88 @@
 
 #define SHM_INPUT 1    
 #define FAKE_INPUT 2
+#define SHM_RING_INPUT 3
 
 #define COMMAND_LINE_OUTPUT 1  
 #define WIRING_OUTPUT 2  
 
+#define SPI_LED_OUTPUT 1
+#define NULL_LED_OUTPUT 2
+#define MEMORY_LED_OUTPUT 3
+#define FILE_LED_OUTPUT 4
+#define UDP_LED_OUTPUT 5
+
+#define RAW_LED_ENCODING 1
+#define APA102_LED_ENCODING 2
+#define WS2812_LED_ENCODING 3
+
+#define MAX_LED_TARGET_LENGTH 128
+#define DEFAULT_SPI_DEVICE "/dev/spidev0.0"
+#define DEFAULT_LED_LOG_FILE "led_frames.log"
+#define DEFAULT_LED_UDP_TARGET "127.0.0.1:7890"
+#define DEFAULT_LED_KEEP_ALIVE 100 /*ms*/
+#define DEFAULT_RENDER_LAG 250 /*ms*/
+
+/*LED topology, the strip is made of segments wired to one or more buses*/
+#define MAX_LED_BUSES 4
+#define MAX_LED_SEGMENTS 16
+#define DEFAULT_NB_LEDS 157
+#define DEFAULT_LED_BUS_SPEED 1000000 /*Hz*/
+#define DEFAULT_WS2812_BUS_SPEED 2400000 /*Hz, the WS2812 encoding is timed for it*/
+#define DEFAULT_LED_GAMMA 1.0 /*no correction*/
+#define DEFAULT_LED_BRIGHTNESS 1.0
+
 #define MAX_CHAR_FIELD_LENGTH 18
 
+#define MAX_NB_PLAYERS 2
+
+#define DEFAULT_TICK_RATE 100.0 /*Hz*/
+#define DEFAULT_INTEGRATION_PERIOD 0.25 /*s, timestep of the explosion*/
+#define DEFAULT_INTEGRATION_GAIN (1.0/75.0) /*per period*/
+#define DEFAULT_SAMPLE_RATE 220.0 /*Hz, of the EEG*/
+
+/*training ends early once the estimates converge*/
+#define DEFAULT_TRAINING_MIN_SIZE 8
+#define DEFAULT_TRAINING_TOLERANCE 0.15 /*relative half-width of the 95% interval of the mean*/
+
+/*calibration profiles, a stored profile is verified instead of a full training*/
+#define MAX_CALIB_PROFILE_PATH_LENGTH 128
+#define DEFAULT_VERIFICATION_SIZE 5
+#define MIN_VERIFICATION_SIZE 2 /*to estimate the spread*/
+#define DEFAULT_PROFILE_TOLERANCE 1.0 /*shift of the mean, in stored standard deviations*/
+
+/*adaptive normalization during the game, off by default*/
+#define DEFAULT_ADAPTIVE_HALF_LIFE 0.0 /*samples*/
+#define DEFAULT_ADAPTIVE_GATE 2.0 /*z-score*/
+#define DEFAULT_ADAPTIVE_MAX_DRIFT 1.0 /*trained standard deviations*/
+
+typedef struct led_bus_config_s {
+	char output; /*type of LED output*/
+	char target[MAX_LED_TARGET_LENGTH]; /*device, file or host:port*/
+	int speed_hz; /*SPI clock*/
+	char encoding; /*wire format of the LED chipset*/
+	double gamma;
+	double brightness; /*between 0 and 1*/
+} led_bus_config_t;
+
+typedef struct led_segment_config_s {
+	int bus; /*index of the bus it is wired to*/
+	int length; /*number of LEDs*/
+	char reversed; /*wired from its last LED, in the order of the strip*/
+} led_segment_config_t;
+
 typedef struct appconfig_s {
 	
 	char debug;
 	
 	/*feature source config*/
 	char feature_source;
+	char player_source[MAX_NB_PLAYERS]; /*per player, defaults to feature_source*/
 	
 	/*feature vect config*/
 	int nb_channels;
 	int window_width;
+	double sample_rate; /*of the EEG, sets the resolution of the FFT (Hz)*/
 	int buffer_depth;
 	char timeseries;
 	char fft;
@@ -38,9 +104,36 @@ typedef struct appconfig_s {
 	char eeg_hardware_required;
 	
 	/*exp related variables*/
-	int training_set_size;
+	int training_set_size; /*maximum number of training samples*/
+	int training_min_size; /*minimum before the training may end early*/
+	double training_tolerance; /*0 to always use training_set_size samples*/
 	double test_duration;
 	double avg_kernel;
+	double tick_rate; /*game loop rate (Hz)*/
+	double integration_period; /*s, the difference between players is integrated on this timestep*/
+	double integration_gain; /*share of the strip moved per period, for a full difference*/
+	
+	/*calibration profiles, kept between sessions*/
+	char calibration_profiles[MAX_CALIB_PROFILE_PATH_LENGTH]; /*file, empty to always train in full*/
+	uint32_t player_id[MAX_NB_PLAYERS]; /*key of the profile of each player, defaults to its slot*/
+	int verification_size; /*samples checked against the profile*/
+	double profile_tolerance;
+	
+	/*the reference of the normalization follows the drift during the game*/
+	double adaptive_half_life; /*samples, 0 keeps the reference of the training*/
+	double adaptive_gate; /*samples further than this z-score leave the reference alone*/
+	double adaptive_max_drift;
+	
+	/*LED strip output, segments in the order of the strip*/
+	int nb_led_buses;
+	led_bus_config_t led_bus[MAX_LED_BUSES];
+	int nb_led_segments;
+	led_segment_config_t led_segment[MAX_LED_SEGMENTS];
+	int led_keep_alive; /*ms between transfers of an unchanged strip, 0 sends every frame*/
+	int render_lag; /*ms the rendering lags the game state, to interpolate it*/
+	
+	/*random generators*/
+	uint64_t seed; /*seed of the run, 0 for a new one on each run*/
 	
 } appconfig_t;
 
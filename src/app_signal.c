@@ -11,6 +11,7 @@
 
 #include "app_signal.h"
 #include "feature_input.h"
+#include "gpio_wrapper.h"
 
 extern char task_running;
 extern char program_running;
@@ -24,4 +25,5 @@ void ctrl_c_handler(int signal)
 	fprintf(stdout, "Interrupt caught[NO: %d ]\n", signal);
 	task_running = 0x00;
 	program_running = 0x00;
+	cancel_wait_for_start_demo();
 }
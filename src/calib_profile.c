@@ -0,0 +1,322 @@
+/**
+ * @file calib_profile.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Calibration profiles of the players, kept in a small binary file
+ * between sessions. The file is written in full to a temporary file which then
+ * replaces the previous one, such that a crash never leaves half a file behind.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "calib_profile.h"
+#include "xml.h"
+
+#define CALIB_HEADER_SIZE 12
+#define CALIB_PROFILE_HEAD_SIZE 16 /*id, nb_samples, trained_at*/
+#define CALIB_FEATURE_SIZE 16 /*mean, std*/
+#define CALIB_TRAILER_SIZE 4
+#define CALIB_MAX_FILE_SIZE (CALIB_HEADER_SIZE+MAX_CALIB_PROFILES*(CALIB_PROFILE_HEAD_SIZE+RUNNING_STATS_MAX_DIM*CALIB_FEATURE_SIZE)+CALIB_TRAILER_SIZE)
+
+/*the std of the samples verified may be off by this factor, few samples give a loose estimate*/
+#define CALIB_STD_RATIO 3.0
+
+static void put_u16(uint8_t* buf, uint16_t value);
+static void put_u32(uint8_t* buf, uint32_t value);
+static void put_u64(uint8_t* buf, uint64_t value);
+static void put_f64(uint8_t* buf, double value);
+static uint16_t get_u16(const uint8_t* buf);
+static uint32_t get_u32(const uint8_t* buf);
+static uint64_t get_u64(const uint8_t* buf);
+static double get_f64(const uint8_t* buf);
+static uint32_t fnv1a(const uint8_t* buf, size_t size);
+
+/**
+ * void calib_profiles_init(calib_profiles_t* profiles, int nb_features)
+ * @brief initialize an empty set of profiles
+ * @param profiles, set of profiles
+ * @param nb_features, number of features calibrated
+ */
+void calib_profiles_init(calib_profiles_t* profiles, int nb_features){
+	
+	profiles->nb_features = nb_features<RUNNING_STATS_MAX_DIM?nb_features:RUNNING_STATS_MAX_DIM;
+	profiles->nb_profiles = 0;
+}
+
+/**
+ * int calib_profiles_load(calib_profiles_t* profiles, const char* filename)
+ * @brief read the profiles from the file, the set is left empty if there is none
+ * @param profiles, set of profiles, initialized with the number of features
+ * @param filename, file of the profiles
+ * @return EXIT_SUCCESS if read or not created yet, EXIT_FAILURE if unreadable
+ */
+int calib_profiles_load(calib_profiles_t* profiles, const char* filename){
+	
+	static uint8_t buf[CALIB_MAX_FILE_SIZE+1];
+	FILE* file;
+	size_t size;
+	size_t offset;
+	uint32_t nb_profiles;
+	uint32_t i;
+	int k;
+	
+	profiles->nb_profiles = 0;
+	
+	file = fopen(filename, "rb");
+	if(file == NULL){
+		/*first session*/
+		return EXIT_SUCCESS;
+	}
+	size = fread(buf, 1, sizeof(buf), file);
+	fclose(file);
+	
+	if(size < CALIB_HEADER_SIZE+CALIB_TRAILER_SIZE || memcmp(buf, CALIB_PROFILE_MAGIC, 4) != 0){
+		fprintf(stderr, "Calibration profiles: %s is not a profile file\n", filename);
+		return EXIT_FAILURE;
+	}
+	
+	if(get_u16(&(buf[4])) != CALIB_PROFILE_VERSION){
+		fprintf(stderr, "Calibration profiles: %s is version %u, expected %u\n", filename,
+				get_u16(&(buf[4])), CALIB_PROFILE_VERSION);
+		return EXIT_FAILURE;
+	}
+	
+	if(get_u16(&(buf[6])) != profiles->nb_features){
+		fprintf(stderr, "Calibration profiles: %s has %u features, expected %i\n", filename,
+				get_u16(&(buf[6])), profiles->nb_features);
+		return EXIT_FAILURE;
+	}
+	
+	nb_profiles = get_u32(&(buf[8]));
+	/*bounded first, such that the size can't overflow*/
+	if(nb_profiles > MAX_CALIB_PROFILES ||
+	   size != CALIB_HEADER_SIZE+(size_t)nb_profiles*(CALIB_PROFILE_HEAD_SIZE+(size_t)profiles->nb_features*CALIB_FEATURE_SIZE)+CALIB_TRAILER_SIZE ||
+	   get_u32(&(buf[size-CALIB_TRAILER_SIZE])) != fnv1a(buf, size-CALIB_TRAILER_SIZE)){
+		fprintf(stderr, "Calibration profiles: %s is corrupted\n", filename);
+		return EXIT_FAILURE;
+	}
+	
+	offset = CALIB_HEADER_SIZE;
+	for(i=0;i<nb_profiles;i++){
+		
+		profiles->profile[i].id = get_u32(&(buf[offset]));
+		profiles->profile[i].nb_samples = get_u32(&(buf[offset+4]));
+		profiles->profile[i].trained_at = (int64_t)get_u64(&(buf[offset+8]));
+		profiles->profile[i].nb_features = profiles->nb_features;
+		offset += CALIB_PROFILE_HEAD_SIZE;
+		
+		for(k=0;k<profiles->nb_features;k++){
+			profiles->profile[i].mean[k] = get_f64(&(buf[offset]));
+			profiles->profile[i].std_dev[k] = get_f64(&(buf[offset+8]));
+			offset += CALIB_FEATURE_SIZE;
+		}
+	}
+	profiles->nb_profiles = nb_profiles;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int calib_profiles_save(const calib_profiles_t* profiles, const char* filename)
+ * @brief write the profiles to the file, replacing it
+ * @param profiles, set of profiles
+ * @param filename, file of the profiles
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int calib_profiles_save(const calib_profiles_t* profiles, const char* filename){
+	
+	static uint8_t buf[CALIB_MAX_FILE_SIZE];
+	char tmp_filename[MAX_CALIB_PROFILE_PATH_LENGTH+8];
+	FILE* file;
+	size_t offset;
+	int i, k;
+	
+	memcpy(buf, CALIB_PROFILE_MAGIC, 4);
+	put_u16(&(buf[4]), CALIB_PROFILE_VERSION);
+	put_u16(&(buf[6]), profiles->nb_features);
+	put_u32(&(buf[8]), profiles->nb_profiles);
+	
+	offset = CALIB_HEADER_SIZE;
+	for(i=0;i<profiles->nb_profiles;i++){
+		
+		put_u32(&(buf[offset]), profiles->profile[i].id);
+		put_u32(&(buf[offset+4]), profiles->profile[i].nb_samples);
+		put_u64(&(buf[offset+8]), (uint64_t)profiles->profile[i].trained_at);
+		offset += CALIB_PROFILE_HEAD_SIZE;
+		
+		for(k=0;k<profiles->nb_features;k++){
+			put_f64(&(buf[offset]), profiles->profile[i].mean[k]);
+			put_f64(&(buf[offset+8]), profiles->profile[i].std_dev[k]);
+			offset += CALIB_FEATURE_SIZE;
+		}
+	}
+	put_u32(&(buf[offset]), fnv1a(buf, offset));
+	offset += CALIB_TRAILER_SIZE;
+	
+	snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+	file = fopen(tmp_filename, "wb");
+	if(file == NULL){
+		perror("Calibration profiles: fopen");
+		return EXIT_FAILURE;
+	}
+	
+	if(fwrite(buf, 1, offset, file) != offset || fclose(file) != 0){
+		perror("Calibration profiles: fwrite");
+		remove(tmp_filename);
+		return EXIT_FAILURE;
+	}
+	
+	if(rename(tmp_filename, filename) != 0){
+		perror("Calibration profiles: rename");
+		remove(tmp_filename);
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * const calib_profile_t* calib_profiles_find(const calib_profiles_t* profiles, uint32_t id)
+ * @brief look up the profile of a player
+ * @param profiles, set of profiles
+ * @param id, player slot or player ID
+ * @return the profile, NULL if the player has none
+ */
+const calib_profile_t* calib_profiles_find(const calib_profiles_t* profiles, uint32_t id){
+	
+	int i;
+	
+	for(i=0;i<profiles->nb_profiles;i++){
+		if(profiles->profile[i].id == id){
+			return &(profiles->profile[i]);
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * int calib_profiles_store(calib_profiles_t* profiles, const calib_profile_t* profile)
+ * @brief add the profile to the set, or replace the one of the same player
+ * @param profiles, set of profiles
+ * @param profile, profile to store
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the set is full
+ */
+int calib_profiles_store(calib_profiles_t* profiles, const calib_profile_t* profile){
+	
+	int i;
+	
+	for(i=0;i<profiles->nb_profiles;i++){
+		if(profiles->profile[i].id == profile->id){
+			break;
+		}
+	}
+	
+	if(i == MAX_CALIB_PROFILES){
+		fprintf(stderr, "Calibration profiles: no room for player %u\n", profile->id);
+		return EXIT_FAILURE;
+	}
+	
+	profiles->profile[i] = *profile;
+	profiles->profile[i].nb_features = profiles->nb_features;
+	if(i == profiles->nb_profiles){
+		profiles->nb_profiles++;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int calib_profile_verify(const calib_profile_t* profile, const running_stats_t* stats, double tolerance)
+ * @brief tells if a few samples of the session agree with the stored profile,
+ * the mean of each feature must be within tolerance standard deviations of the
+ * stored mean, and its spread must be of the same order
+ * @param profile, stored profile
+ * @param stats, statistics of the samples of the session
+ * @param tolerance, largest shift of the mean, in stored standard deviations
+ * @return 1 if the profile agrees, 0 otherwise
+ */
+int calib_profile_verify(const calib_profile_t* profile, const running_stats_t* stats, double tolerance){
+	
+	double std_dev;
+	int k;
+	
+	if(stats->n < 2 || stats->dim != profile->nb_features){
+		return 0;
+	}
+	
+	for(k=0;k<profile->nb_features;k++){
+		
+		if(fabs(stats->mean[k]-profile->mean[k]) > tolerance*profile->std_dev[k]){
+			return 0;
+		}
+		
+		std_dev = running_stats_std(stats, k);
+		if(std_dev*CALIB_STD_RATIO < profile->std_dev[k] || std_dev > profile->std_dev[k]*CALIB_STD_RATIO){
+			return 0;
+		}
+	}
+	
+	return 1;
+}
+
+static void put_u16(uint8_t* buf, uint16_t value){
+	
+	buf[0] = (uint8_t)value;
+	buf[1] = (uint8_t)(value>>8);
+}
+
+static void put_u32(uint8_t* buf, uint32_t value){
+	
+	put_u16(buf, (uint16_t)value);
+	put_u16(&(buf[2]), (uint16_t)(value>>16));
+}
+
+static void put_u64(uint8_t* buf, uint64_t value){
+	
+	put_u32(buf, (uint32_t)value);
+	put_u32(&(buf[4]), (uint32_t)(value>>32));
+}
+
+static void put_f64(uint8_t* buf, double value){
+	
+	uint64_t bits;
+	
+	memcpy(&bits, &value, sizeof(bits));
+	put_u64(buf, bits);
+}
+
+static uint16_t get_u16(const uint8_t* buf){
+	return (uint16_t)(buf[0]|(buf[1]<<8));
+}
+
+static uint32_t get_u32(const uint8_t* buf){
+	return (uint32_t)get_u16(buf)|((uint32_t)get_u16(&(buf[2]))<<16);
+}
+
+static uint64_t get_u64(const uint8_t* buf){
+	return (uint64_t)get_u32(buf)|((uint64_t)get_u32(&(buf[4]))<<32);
+}
+
+static double get_f64(const uint8_t* buf){
+	
+	uint64_t bits = get_u64(buf);
+	double value;
+	
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static uint32_t fnv1a(const uint8_t* buf, size_t size){
+	
+	uint32_t hash = 2166136261u;
+	size_t i;
+	
+	for(i=0;i<size;i++){
+		hash = (hash^buf[i])*16777619u;
+	}
+	
+	return hash;
+}
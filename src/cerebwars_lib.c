@@ -1,7 +1,3 @@
-
-
-
-
 #include <stdint.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -11,20 +7,18 @@
 #include <fcntl.h>
 #include <pthread.h>
 #include <math.h>
-#include <sys/ioctl.h>
-#include <linux/types.h>
-#include <linux/spi/spidev.h>
 
 #include "cerebwars_lib.h"
+#include "led_strip.h"
+#include "particles.h"
+#include "led_topology.h"
+#include "tick_scheduler.h"
+#include "cmd_queue.h"
+#include "seqlock.h"
+#include "prng.h"
+#include "led_layers.h"
 
 
-#define NB_LEDS 157   
-#define PARTICLE_LENGTH 4
-#define NB_COLORS 3
-#define RED 0
-#define GREEN 1
-#define BLUE 2
-
 #define BEGIN 0
 #define END 1
 
@@ -36,151 +30,483 @@
 #define UPDATE_PERIOD_MIN 2
 #define UPDATE_PERIOD_SPAN 6
 #define DEFAULT_UPDATE_PERIOD 9
-
-typedef struct pixel_s{
-	
-	uint8_t red;
-	uint8_t green;
-	uint8_t blue;
-}pixel_t;
+#define DEFAULT_SPEED (Q16_ONE/(DEFAULT_UPDATE_PERIOD+1))
+#define GAME_HISTORY_SIZE 64 /*snapshots kept, a game tick each, must cover the render lag*/
+
+/*chance of a particle to be spawned, on each roll of the dice*/
+#define SPAWN_CHANCE PRNG_CHANCE(0.5)
+#define TRAIN_SPAWN_CHANCE PRNG_CHANCE(0.34)
+
+#define RENDER_PRNG_STREAM 0 /*random stream of the renderer thread*/
+
+#define FRAME_RATE 200.0 /*frames per second, rendered and sent*/
+#define IDLE_FRAME_RATE 10.0 /*between games, commands are executed as they arrive*/
+
+/*commands of the renderer*/
+#define CMD_MODE 0 /*arg is the new RENDER_* mode*/
+#define CMD_EFFECT 1 /*arg is the EFFECT_* to play*/
+#define CMD_EXIT 2
+#define CMD_WINNER 3 /*arg is the winning player, before the winner mode*/
+#define CMD_COUNTDOWN 4 /*countdown effect, arg is its length in seconds*/
+
+#define NO_EFFECT -1
+#define FLASH_FRAMES 40 /*length of the flash effect*/
+#define FRAMES_PER_SECOND ((int)FRAME_RATE)
+#define COUNTDOWN_SPACING 2 /*LEDs between the marks of the countdown*/
+#define COUNTDOWN_MIN_LEVEL 32 /*brightness of the marks at the end of each second*/
+#define WINNER_PULSE_FRAMES 100 /*period of the winner flash*/
+#define WINNER_PULSE_LEVEL 64 /*peak brightness of the winner flash*/
+#define ATTRACT_PERIOD_FRAMES 40 /*period of the attract animation, at the idle rate*/
+#define ATTRACT_LEVEL 48 /*peak brightness of the attract animation*/
+
+/*layers of the strip, added in this order*/
+#define LAYER_BACKGROUND 0 /*train and winner animations*/
+#define LAYER_PLAYER_1 1 /*particles of each player*/
+#define LAYER_PLAYER_2 2
+#define LAYER_EXPLOSION 3
+#define LAYER_OVERLAY 4 /*countdown, effects and winner flash*/
+#define NB_LAYERS 5
 
 pixel_t BLACK_PIXEL = {0,0,0};
 const unsigned char particle_kernel[PARTICLE_LENGTH] = {0, 15, 30, 255};
-const unsigned char player_mask[NB_PLAYERS][NB_COLORS] = {{1, 0, 0},
-														  {0, 0, 1}};
+const pixel_t player_color[NB_PLAYERS] = {{255, 0, 0},
+										  {0, 0, 255}};
+const pixel_t train_color = {0, 255, 0};
 #define EXPLOSION_SIZE 8
 const unsigned char explosion_kernel[EXPLOSION_SIZE] = {15, 30, 75, 150, 150, 75, 30, 15};
-const float explosion_animation_kernel[EXPLOSION_SIZE] = {0.1, 0.3, 0.5, 0.7, 0.7, 0.5, 0.3, 0.1};
+/*chance of each pixel of the explosion to be painted, on each frame*/
+const uint32_t explosion_animation_chance[EXPLOSION_SIZE] = {PRNG_CHANCE(0.9), PRNG_CHANCE(0.7), PRNG_CHANCE(0.5),
+															 PRNG_CHANCE(0.3), PRNG_CHANCE(0.3), PRNG_CHANCE(0.5),
+															 PRNG_CHANCE(0.7), PRNG_CHANCE(0.9)};
+
+/*
+ * State of the game, set by the game loop and read by the renderer. A snapshot
+ * is published on each game tick with the time it was published, in a short
+ * history guarded by a seqlock, such that the renderer can interpolate between
+ * the two snapshots around the time of its frame, without locking either thread.
+ */
+typedef struct game_state_s{
+	
+	uint32_t version; /*incremented on each update*/
+	struct timespec time; /*when published*/
+	int32_t player_speed[NB_PLAYERS]; /*LEDs per frame, Q16*/
+	int32_t explosion_location; /*LED, Q16*/
+	
+}game_state_t;
+
+typedef struct game_history_s{
+	uint32_t nb_snapshots; /*published, the last GAME_HISTORY_SIZE are kept*/
+	game_state_t snapshot[GAME_HISTORY_SIZE];
+}game_history_t;
+
+/*state a frame is rendered from, interpolated from the snapshots*/
+typedef struct frame_state_s{
+	
+	int32_t player_speed[NB_PLAYERS]; /*LEDs per frame, Q16*/
+	int explosion_location; /*LED*/
+	
+}frame_state_t;
+
+/*
+ * State of the renderer thread. It owns the LED output for the lifetime of
+ * the application and renders the current mode, one frame per tick.
+ */
+typedef struct renderer_s{
+	
+	pthread_t thread;
+	tick_scheduler_t sched;
+	cmd_queue_t commands; /*from the main thread*/
+	prng_t prng; /*dice of the animations*/
+	char running;
+	char idle; /*ticking at the idle rate*/
+	
+	int mode; /*RENDER_* */
+	int effect; /*EFFECT_* being played, NO_EFFECT otherwise*/
+	int effect_frame; /*frames since the effect started*/
+	int effect_length; /*frames*/
+	
+	/*animations are painted in layers, then added in the strip*/
+	led_layer_t layers[NB_LAYERS];
+	
+	/*frame being rendered, split over the buses once done*/
+	int nb_leds;
+	pixel_t strip[MAX_NB_LEDS];
+	
+	/*attract mode*/
+	int attract_frame;
+	
+	/*play mode*/
+	particle_list_t particles[NB_PLAYERS];
+	int32_t spawn_phase[NB_PLAYERS]; /*distance moved since the last dice roll, Q16*/
+	
+	/*train and winner modes*/
+	int winner; /*winning player*/
+	pixel_t stream_color; /*color of the particles leaving the explosion*/
+	strip_segment_t segment[2];
+	unsigned char particle_counter[2];
+	int train_counter[2];
+	
+}renderer_t;
 
 void copy_pixel(pixel_t* dest, pixel_t* src);
 void copy_explosion_pixel(pixel_t* dest, int intensity);
-void paint_explosion(pixel_t* buffer);
-char is_exploding(pixel_t* buffer, int explosion_location);
+void copy_train_pixel(pixel_t* dest, int particle_counter, const pixel_t* color);
+void paint_explosion(pixel_t* buffer, int nb_leds, int explosion_location, prng_t* prng);
+char is_exploding(particle_list_t* particles, int explosion_location);
+void render_game_layers(led_layer_t* layers, int nb_leds, particle_list_t* particles, int explosion_location, prng_t* prng);
+
+static void* renderer_loop(void* param);
+static int renderer_command(int type, int arg);
+static void renderer_execute(renderer_t* rend, const queue_cmd_t* cmd);
+static void read_game_state(frame_state_t* state, int nb_leds, long lag_ns);
+static void render_play_frame(renderer_t* rend, const frame_state_t* state);
+static void render_train_frame(renderer_t* rend, const frame_state_t* state);
+static void render_attract_frame(renderer_t* rend);
+static void render_overlay(renderer_t* rend, const frame_state_t* state);
+static void renderer_set_idle(renderer_t* rend);
+
+static seqlock_t game_state_lock = SEQLOCK_INIT;
+static game_history_t game_history = {1, {{0, {0, 0}, {DEFAULT_SPEED,DEFAULT_SPEED}, 0}}};
+static game_state_t pending_state = {0, {0, 0}, {DEFAULT_SPEED,DEFAULT_SPEED}, 0}; /*owned by the game loop*/
+static long render_lag_ns = 0;
+static uint64_t render_seed = 0;
+static led_topology_t led_topology; /*empty until buses are added*/
+static renderer_t renderer;
 
-void* cereb_strip_loop(void* param);
-void* cereb_train_loop(void* param);
+/**
+ * int add_led_bus(char output_type, const char* target, int speed_hz, char encoding, double gamma, double brightness, int keep_alive_ms)
+ * @brief add an output the LED frames are sent to, by its own writer thread.
+ *        Buses are indexed in the order they are added and must be added 
+ *        before the renderer is started.
+ * @param output_type, type of LED output (SPI_LED_OUTPUT, NULL_LED_OUTPUT, ...)
+ * @param target, device, file or host:port of the output
+ * @param speed_hz, SPI clock
+ * @param encoding, wire format of the LEDs (RAW_LED_ENCODING, APA102_LED_ENCODING, ...)
+ * @param gamma, exponent of the color correction, 1.0 for none
+ * @param brightness, scale of the levels, between 0 and 1
+ * @param keep_alive_ms, longest time without a transfer while the strip doesn't 
+ *        change, 0 to send every frame
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int add_led_bus(char output_type, const char* target, int speed_hz, char encoding, double gamma, double brightness, int keep_alive_ms){
+	return led_topology_add_bus(&led_topology, output_type, target, speed_hz, encoding, gamma, brightness, keep_alive_ms*1000000L);
+}
 
-double player_rate[NB_PLAYERS] = {0.5,0.5};
-int player_period[NB_PLAYERS] = {DEFAULT_UPDATE_PERIOD,DEFAULT_UPDATE_PERIOD};
-int explosion_location = NB_LEDS/2;
-char alive = 0x01;
+/**
+ * int add_led_segment(int bus, int length, char reversed)
+ * @brief add a segment at the end of the LED strip, must be called before
+ *        the renderer is started
+ * @param bus, index of the bus the segment is wired to
+ * @param length, number of LEDs
+ * @param reversed, 1 if wired from its last LED, 0 otherwise
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int add_led_segment(int bus, int length, char reversed){
+	return led_topology_add_segment(&led_topology, bus, length, reversed);
+}
 
 /**
- * int cerebral_wars_winner_mode()
- * @brief starts cerebral wars in normal mode
+ * int start_cerebral_wars_renderer()
+ * @brief open the LED outputs and create the renderer thread, it starts idle.
+ *        The modes are then changed with commands, taking effect on the next frame.
+ *        While idle or in attract mode, the renderer and the writers tick at
+ *        IDLE_FRAME_RATE and sleep until a command or a frame arrives.
+ * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-int start_cerebral_wars(){
+int start_cerebral_wars_renderer(){
 	
-	pthread_t cereb_loop;
-	pthread_attr_t attr;
-	char res;
-
-	/*configure threads*/
-	res = pthread_attr_init(&attr);
-	if (res != 0)
+	int i;
+	
+	cmd_queue_init(&(renderer.commands));
+	renderer.mode = RENDER_IDLE;
+	renderer.effect = NO_EFFECT;
+	renderer.running = 0x01;
+	renderer.idle = 0x00;
+	renderer.nb_leds = led_topology.nb_leds;
+	prng_seed(&(renderer.prng), render_seed, RENDER_PRNG_STREAM);
+	for(i=0;i<NB_LAYERS;i++){
+		layer_init(&(renderer.layers[i]));
+	}
+	
+	if(renderer.nb_leds == 0){
+		fprintf(stderr, "Renderer: the LED strip has no segment\n");
 		return EXIT_FAILURE;
+	}
 	
-	alive = 0x01;
+	/*the explosion starts in the middle of the strip*/
+	pending_state.explosion_location = INT_TO_Q16(renderer.nb_leds/2);
+	game_history.snapshot[0].explosion_location = pending_state.explosion_location;
 	
-	/*configure threads*/
-	pthread_create(&cereb_loop, &attr,
-				   cereb_strip_loop, NULL);
+	/*the outputs stay open until the renderer is stopped*/
+	if(start_led_topology(&led_topology, FRAME_RATE) == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	
+	if(tick_scheduler_init(&(renderer.sched), FRAME_RATE) == EXIT_FAILURE){
+		stop_led_topology(&led_topology);
+		return EXIT_FAILURE;
+	}
+	renderer_set_idle(&renderer);
+	
+	if(pthread_create(&(renderer.thread), NULL, renderer_loop, (void*)&renderer) != 0){
+		perror("renderer");
+		stop_led_topology(&led_topology);
+		return EXIT_FAILURE;
+	}
 	
 	return EXIT_SUCCESS;
 }
 
-
 /**
- * int cerebral_wars_winner_mode()
- * @brief starts cerebral wars in training mode
+ * int stop_cerebral_wars_renderer()
+ * @brief turn off the LED strip, join the renderer thread and close the LED outputs
+ * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-int cerebral_wars_training_mode(){
+int stop_cerebral_wars_renderer(){
 	
-	pthread_t cereb_loop;
-	pthread_attr_t attr;
-	char res;
-
-	/*configure threads*/
-	res = pthread_attr_init(&attr);
-	if (res != 0)
+	if(renderer_command(CMD_EXIT, 0) == EXIT_FAILURE){
 		return EXIT_FAILURE;
+	}
 	
-	alive = 0x01;
-	
-	/*configure threads*/
-	pthread_create(&cereb_loop, &attr,
-				   cereb_train_loop, NULL);
-	
+	pthread_join(renderer.thread, NULL);
 	return EXIT_SUCCESS;
 }
 
 /**
- * int cerebral_wars_winner_mode()
- * @brief starts cerebral wars in winner mode
+ * int start_cerebral_wars()
+ * @brief starts cerebral wars in normal mode
+ * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-int cerebral_wars_winner_mode(){
-	
-	pthread_t cereb_loop;
-	pthread_attr_t attr;
-	char res;
+int start_cerebral_wars(){
+	return renderer_command(CMD_MODE, RENDER_PLAY);
+}
 
-	/*configure threads*/
-	res = pthread_attr_init(&attr);
-	if (res != 0)
-		return EXIT_FAILURE;
-	
-	alive = 0x01;
-	
-	/*configure threads*/
-	pthread_create(&cereb_loop, &attr,
-				   cereb_train_loop, NULL);
+/**
+ * int cerebral_wars_training_mode()
+ * @brief starts cerebral wars in training mode
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int cerebral_wars_training_mode(){
+	return renderer_command(CMD_MODE, RENDER_TRAIN);
+}
+
+/**
+ * int cerebral_wars_attract_mode()
+ * @brief between games, a slow dim animation at the idle rate
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int cerebral_wars_attract_mode(){
+	return renderer_command(CMD_MODE, RENDER_ATTRACT);
+}
+
+/**
+ * int cerebral_wars_winner_mode(int player)
+ * @brief starts cerebral wars in winner mode, particles of the winner's color
+ *        leave the explosion toward both ends, under a flash of the same color
+ * @param player, index of the winning player
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int cerebral_wars_winner_mode(int player){
 	
-	return EXIT_SUCCESS;
+	if(renderer_command(CMD_WINNER, player) == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
 	
+	return renderer_command(CMD_MODE, RENDER_WINNER);
+}
+
+/**
+ * int cerebral_wars_countdown(int seconds)
+ * @brief show a countdown over the current mode, one mark per second left
+ *        at the explosion site
+ * @param seconds, length of the countdown
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int cerebral_wars_countdown(int seconds){
+	return renderer_command(CMD_COUNTDOWN, seconds);
+}
+
+/**
+ * int cerebral_wars_effect(int effect)
+ * @brief play a one-shot effect over the current mode
+ * @param effect, EFFECT_*
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int cerebral_wars_effect(int effect){
+	return renderer_command(CMD_EFFECT, effect);
 }
 
 /**
  * void stop_cerebral_wars()
- * @brief Kills any on-going cerebral wars thread
+ * @brief Turns off the LED strip, the renderer goes idle
  */
 void stop_cerebral_wars(){
-	/*stop currently running thread*/
-	alive = 0x00;
+	renderer_command(CMD_MODE, RENDER_IDLE);
 }
 
+/**
+ * void set_render_lag(int lag_ms)
+ * @brief set how far behind the last game state the frames are rendered, 
+ *        must be called before the renderer is started. The renderer 
+ *        interpolates between the snapshots around the time of the frame, with 
+ *        no lag it holds the last one.
+ * @param lag_ms, lag of the rendering
+ */
+void set_render_lag(int lag_ms){
+	render_lag_ns = lag_ms*1000000L;
+}
+
+/**
+ * void set_render_seed(uint64_t seed)
+ * @brief set the seed of the animations, must be called before the renderer
+ *        is started. The same seed and game state give the same frames.
+ * @param seed, seed of the run
+ */
+void set_render_seed(uint64_t seed){
+	render_seed = seed;
+}
 
+/**
+ * void set_player_rate(double rate, int player)
+ * @brief set the rate of a player, from the game loop. The speed of its 
+ *        particles follows it continuously, from one LED every 
+ *        UPDATE_PERIOD_MIN+1 frames at 1, to UPDATE_PERIOD_SPAN frames slower 
+ *        at 0. It is seen by the renderer once published.
+ * @param rate, adjusted sample of the player, between 0 and 1
+ * @param player, player index
+ */
 void set_player_rate(double rate, int player){
-	player_period[player] = round((1-rate)*UPDATE_PERIOD_SPAN)+UPDATE_PERIOD_MIN;
 	
+	int32_t speed;
+	
+	rate = rate<0.0?0.0:(rate>1.0?1.0:rate);
+	speed = (int32_t)(Q16_ONE/((1-rate)*UPDATE_PERIOD_SPAN+UPDATE_PERIOD_MIN+1));
+	
+	pending_state.player_speed[player] = speed;
 }
 
+/**
+ * void set_explosion_location(double relative_position)
+ * @brief set the location of the explosion, from the game loop. It is seen
+ *        by the renderer once published.
+ * @param relative_position, location between 0 (beginning) and 1 (end of the strip)
+ */
 void set_explosion_location(double relative_position){
-	explosion_location = (NB_LEDS*relative_position);
+	
+	pending_state.explosion_location = (int32_t)(led_topology.nb_leds*relative_position*Q16_ONE);
+}
+
+/**
+ * void publish_game_state()
+ * @brief publish the game state set since the last call, as a new snapshot
+ *        timestamped now. It is published on each tick even if it didn't 
+ *        change, such that a still state is rendered still.
+ */
+void publish_game_state(){
+	
+	clock_gettime(CLOCK_MONOTONIC, &(pending_state.time));
+	pending_state.version++;
+	
+	seqlock_write_begin(&game_state_lock);
+	game_history.snapshot[game_history.nb_snapshots%GAME_HISTORY_SIZE] = pending_state;
+	game_history.nb_snapshots++;
+	seqlock_write_end(&game_state_lock);
 }
 
 /**
- * void paint_explosion(pixel_t* buffer)
- * @brief Paint the explosion over the LED strip, overwriting particles
- * @param buffer, LED strip
+ * void read_game_state(frame_state_t* state, int nb_leds, long lag_ns)
+ * @brief get the state of the game at the time of the frame, minus the lag,
+ *        interpolated between the two snapshots around it, in fixed point. 
+ *        Past the last snapshot it is held, before the oldest it is the oldest.
+ * @param (out)state, state to render the frame from
+ * @param nb_leds, length of the LED strip
+ * @param lag_ns, lag of the rendering
  */
-void paint_explosion(pixel_t* buffer){
+static void read_game_state(frame_state_t* state, int nb_leds, long lag_ns){
+	
+	game_state_t from;
+	game_state_t to;
+	struct timespec target;
+	long long interval_ns;
+	long long elapsed_ns;
+	int64_t alpha = 0;
+	uint32_t newest;
+	uint32_t nb_kept;
+	uint32_t i;
+	int32_t location;
+	int player;
+	uint32_t seq;
+	
+	clock_gettime(CLOCK_MONOTONIC, &target);
+	timespec_add_ns(&target, -lag_ns);
+	
+	/*newest snapshot not after the target, and the one following it*/
+	do{
+		seq = seqlock_read_begin(&game_state_lock);
+		newest = game_history.nb_snapshots-1;
+		nb_kept = game_history.nb_snapshots<GAME_HISTORY_SIZE?game_history.nb_snapshots:GAME_HISTORY_SIZE;
+		
+		for(i=0;i<nb_kept;i++){
+			if(timespec_diff_ns(&target, &(game_history.snapshot[(newest-i)%GAME_HISTORY_SIZE].time)) >= 0){
+				break;
+			}
+		}
+		
+		if(i == nb_kept){
+			/*older than the history, the oldest is held*/
+			i = nb_kept-1;
+			from = game_history.snapshot[(newest-i)%GAME_HISTORY_SIZE];
+			to = from;
+		}else{
+			from = game_history.snapshot[(newest-i)%GAME_HISTORY_SIZE];
+			to = game_history.snapshot[(newest-(i>0?i-1:0))%GAME_HISTORY_SIZE];
+		}
+	}while(seqlock_read_retry(&game_state_lock, seq));
+	
+	/*Q16 position of the target between the two, below 1*/
+	interval_ns = timespec_diff_ns(&(to.time), &(from.time));
+	if(interval_ns > 0){
+		elapsed_ns = timespec_diff_ns(&target, &(from.time));
+		alpha = elapsed_ns<0?0:(elapsed_ns>=interval_ns?Q16_ONE:(elapsed_ns<<Q16_SHIFT)/interval_ns);
+	}
+	
+	for(player=0;player<NB_PLAYERS;player++){
+		state->player_speed[player] = from.player_speed[player] + 
+			(((int64_t)(to.player_speed[player]-from.player_speed[player])*alpha)>>Q16_SHIFT);
+		if(state->player_speed[player] < 0){
+			state->player_speed[player] = 0;
+		}
+	}
+	
+	/*within the strip, a relative position of 1 is one past its end*/
+	location = Q16_TO_INT(from.explosion_location +
+		(((int64_t)(to.explosion_location-from.explosion_location)*alpha)>>Q16_SHIFT));
+	state->explosion_location = location<0?0:(location>=nb_leds?nb_leds-1:location);
+}
+
+/**
+ * void paint_explosion(pixel_t* buffer, int nb_leds, int explosion_location, prng_t* prng)
+ * @brief Paint the explosion in its layer, the pixels not painted are left black
+ * @param buffer, layer of the explosion
+ * @param nb_leds, length of the LED strip
+ * @param explosion_location, explosion location in LED strip
+ * @param prng, random generator of the calling thread
+ */
+void paint_explosion(pixel_t* buffer, int nb_leds, int explosion_location, prng_t* prng){
 	
 	int i=0;
 	int cur_pix=0;
 	
-	/*paint explosion on top*/
 	for(i=0;i<EXPLOSION_SIZE;i++){
 		
 		/*compute pixel location*/
 		cur_pix = explosion_location-EXPLOSION_SIZE/2 + i;
 		
 		/*make sure inside LED strip*/
-		if(cur_pix>=0 && cur_pix<NB_LEDS){
+		if(cur_pix>=0 && cur_pix<nb_leds){
 			/*check if pixel is painted*/
-			if(((float)rand()/(float)RAND_MAX)>explosion_animation_kernel[i]){
+			if(prng_next(prng) < explosion_animation_chance[i]){
 				copy_explosion_pixel(&(buffer[cur_pix]), explosion_kernel[i]);
-			}else{
-				copy_pixel(&(buffer[cur_pix]), &(BLACK_PIXEL));
 			}
 		}
 	}
@@ -188,34 +514,55 @@ void paint_explosion(pixel_t* buffer){
 
 
 /**
- * char is_exploding(pixel_t* buffer, int explosion_location)
+ * char is_exploding(particle_list_t* particles, int explosion_location)
  * @brief Check if the LED strip is exploding. For this at least one particle must
  *        be in range of the explosion site
- * @param buffer, LED strip
+ * @param particles, particles of both players
  * @param explosion_location, explosion location in LED strip
- * @return 0x00, if exploding, 0x01 otherwise 
+ * @return 0x01, if exploding, 0x00 otherwise 
  */
-char is_exploding(pixel_t* buffer, int explosion_location){
-
-	int i=0;
-	char exploding = 0x00;
+char is_exploding(particle_list_t* particles, int explosion_location){
+	
+	int low = explosion_location-(EXPLOSION_SIZE/2-1);
+	int high = explosion_location+(EXPLOSION_SIZE/2-1);
 	
 	/*detect particles in explosion range*/
-	for(i=0;i<EXPLOSION_SIZE/2;i++){
-		if(explosion_location+i>=0 && explosion_location+i < NB_LEDS){
-			if(buffer[explosion_location+i].red || buffer[explosion_location+i].blue){
-				exploding=0x01;
-			}
-		}
-		
-		if(explosion_location-i>=0 && explosion_location-i < NB_LEDS){
-			if(buffer[explosion_location-i].red || buffer[explosion_location-i].blue){
-				exploding=0x01;
-			}
+	return particles_in_range(&(particles[PLAYER_1]), low, high) ||
+		   particles_in_range(&(particles[PLAYER_2]), low, high);
+}
+
+/**
+ * void render_game_layers(led_layer_t* layers, int nb_leds, particle_list_t* particles, int explosion_location, prng_t* prng)
+ * @brief Rasterize the particles of each player and the explosion in their layers.
+ *        Only the LEDs they cover are cleared and painted.
+ * @param layers, layers of the strip
+ * @param nb_leds, length of the LED strip
+ * @param particles, particles of both players
+ * @param explosion_location, explosion location in LED strip
+ * @param prng, random generator of the calling thread
+ */
+void render_game_layers(led_layer_t* layers, int nb_leds, particle_list_t* particles, int explosion_location, prng_t* prng){
+	
+	pixel_t* layer;
+	int player;
+	
+	for(player=0;player<NB_PLAYERS;player++){
+		if(particles[player].nb_particles > 0){
+			layer = layer_begin(&(layers[LAYER_PLAYER_1+player]), particles[player].first, particles[player].last);
+			particles_rasterize(&(particles[player]), layer);
+		}else{
+			layer_clear(&(layers[LAYER_PLAYER_1+player]));
 		}
 	}
 	
-	return exploding;
+	/*paint the explosion, if it's exploding*/
+	if(is_exploding(particles, explosion_location)){
+		layer = layer_begin(&(layers[LAYER_EXPLOSION]), explosion_location-EXPLOSION_SIZE/2,
+							explosion_location-EXPLOSION_SIZE/2+EXPLOSION_SIZE-1);
+		paint_explosion(layer, nb_leds, explosion_location, prng);
+	}else{
+		layer_clear(&(layers[LAYER_EXPLOSION]));
+	}
 }
 
 /**
@@ -231,16 +578,16 @@ void copy_pixel(pixel_t* dest, pixel_t* src){
 }
 
 
-void copy_particle_pixel(pixel_t* dest, int player, int particle_counter){
-
-	/*set pixel at player color*/
-	dest->red = player_mask[player][RED]*particle_kernel[particle_counter];
-	dest->green = player_mask[player][GREEN]*particle_kernel[particle_counter];
-	dest->blue = player_mask[player][BLUE]*particle_kernel[particle_counter];
+void copy_train_pixel(pixel_t* dest, int particle_counter, const pixel_t* color){
+	
+	/*set pixel at the color of the stream*/
+	dest->red = color->red*particle_kernel[particle_counter]/255;
+	dest->green = color->green*particle_kernel[particle_counter]/255;
+	dest->blue = color->blue*particle_kernel[particle_counter]/255;
 }
 
 void copy_explosion_pixel(pixel_t* dest, int intensity){
-
+	
 	/*set pixel at player color*/
 	dest->red = intensity;
 	dest->green = intensity;
@@ -248,257 +595,372 @@ void copy_explosion_pixel(pixel_t* dest, int intensity){
 }
 
 /**
- * void* cereb_strip_loop
- * @brief Thread that runs cerebral wars in loop
- * @param unused
+ * int renderer_command(int type, int arg)
+ * @brief queue a command for the renderer, from the main thread only
+ * @param type, CMD_*
+ * @param arg, argument of the command
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the queue is full
+ */
+static int renderer_command(int type, int arg){
+	
+	queue_cmd_t cmd;
+	
+	cmd.type = type;
+	cmd.arg = arg;
+	
+	if(!cmd_queue_push(&(renderer.commands), &cmd)){
+		fprintf(stderr, "Renderer command queue full\n");
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void renderer_execute(renderer_t* rend, const queue_cmd_t* cmd)
+ * @brief execute a command, in the renderer thread
+ * @param rend, reference to the renderer
+ * @param cmd, command to execute
  */
-void* cereb_strip_loop(void* param __attribute__((unused))){
+static void renderer_execute(renderer_t* rend, const queue_cmd_t* cmd){
 	
-	/*define buffer*/
-	pixel_t buffer[NB_LEDS];
+	int player;
 	int i;
-	int spi_driver;
-	unsigned char particle_counter[2] = {0x00,0x00};
-	static uint32_t speed = 1000000;
-	int red_update_counter = 0;
-	int blue_update_counter = 0;
-	int res=0;
-	
-	/*configure spi driver*/
-	spi_driver = open("/dev/spidev0.0",O_RDWR);
-	ioctl(spi_driver, SPI_IOC_WR_MAX_SPEED_HZ, &speed);	
-	
-	/*initialise LED_strip with 0's*/
-	memset(buffer,0,sizeof(pixel_t)*NB_LEDS);
-	
-	/*loop while alive*/
-	while(alive){
+	
+	switch(cmd->type){
 		
-		/************************/
-		/* RED PLAYER SIDE      */
-		/************************/
-		if(red_update_counter<=0){
-			red_update_counter = player_period[PLAYER_1];
+		case CMD_MODE:
+			rend->mode = cmd->arg;
+			rend->stream_color = rend->mode==RENDER_WINNER?player_color[rend->winner]:train_color;
 			
-			/*from the start to explosion*/
-			for(i=explosion_location;i>=0;i--){
-				copy_pixel(&(buffer[i+1]),&(buffer[i]));
+			/*each mode starts from a clear strip, effects keep playing over it*/
+			for(i=0;i<LAYER_OVERLAY;i++){
+				layer_clear(&(rend->layers[i]));
 			}
+			renderer_set_idle(rend);
+			rend->attract_frame = 0;
 			
-			/*check if a particle is being placed at the beginning*/
-			if(particle_counter[BEGIN]>0){
-				
-				/*set pixel at player color*/
-				copy_particle_pixel(&(buffer[0]), PLAYER_1, particle_counter[BEGIN]);
-				
-				/*update particle counter*/
-				particle_counter[BEGIN]--;
-				
-			}else{
-		
-				/*set pixel black*/
-				copy_pixel(&(buffer[0]),&(BLACK_PIXEL));
+			if(rend->mode == RENDER_PLAY){
 				
-				/*else roll a dice to determine if a new particule needs to be spawned*/
-				if(((float)rand()/(float)RAND_MAX)>player_rate[PLAYER_1]){
-					particle_counter[BEGIN] = (PARTICLE_LENGTH-1);
-					
+				/*red particles enter at the beginning, blue ones at the end*/
+				particles_init(&(rend->particles[PLAYER_1]), 0, SEGMENT_ASCENDING, &(player_color[PLAYER_1]), rend->nb_leds);
+				particles_init(&(rend->particles[PLAYER_2]), rend->nb_leds-1, SEGMENT_DESCENDING, &(player_color[PLAYER_2]), rend->nb_leds);
+				for(player=0;player<NB_PLAYERS;player++){
+					rend->spawn_phase[player] = Q16_ONE;
 				}
-			}	
-		}else{
-			red_update_counter--;
-		}
-		
-		/************************/
-		/* BLUE PLAYER SIDE     */
-		/************************/
-		if(blue_update_counter<=0){
-			blue_update_counter = player_period[PLAYER_2];
-			
-			/*from the end to explosion*/
-			/*roll back by bringing encountered values forward*/
-			for(i=explosion_location;i<NB_LEDS;i++){
-				copy_pixel(&(buffer[i-1]),&(buffer[i]));
 			}
-			
-			/*check if a particle is being placed at the end*/
-			if(particle_counter[END]>0){
+			else if(rend->mode == RENDER_TRAIN || rend->mode == RENDER_WINNER){
 				
-				/*set pixel at player color*/
-				copy_particle_pixel(&(buffer[NB_LEDS-1]), PLAYER_2, particle_counter[END]);
-				
-				/*update particle counter*/
-				particle_counter[END]--;
-			}else{
+				/*particles leave the explosion toward both ends*/
+				segment_init(&(rend->segment[END]), SEGMENT_ASCENDING, rend->nb_leds);
+				segment_init(&(rend->segment[BEGIN]), SEGMENT_DESCENDING, rend->nb_leds);
+				rend->particle_counter[BEGIN] = 0;
+				rend->particle_counter[END] = 0;
+				rend->train_counter[BEGIN] = DEFAULT_UPDATE_PERIOD;
+				rend->train_counter[END] = DEFAULT_UPDATE_PERIOD;
+			}
+			break;
+			
+		case CMD_EFFECT:
+			rend->effect = cmd->arg;
+			rend->effect_frame = 0;
+			rend->effect_length = FLASH_FRAMES;
+			break;
+			
+		case CMD_COUNTDOWN:
+			rend->effect = EFFECT_COUNTDOWN;
+			rend->effect_frame = 0;
+			rend->effect_length = cmd->arg*FRAMES_PER_SECOND;
+			break;
+			
+		case CMD_WINNER:
+			rend->winner = cmd->arg;
+			break;
+			
+		case CMD_EXIT:
+			rend->running = 0x00;
+			break;
+	}
+}
+
+/**
+ * void* renderer_loop(void* param)
+ * @brief renderer thread, renders the current mode at the frame rate
+ * @param param, reference to the renderer
+ */
+static void* renderer_loop(void* param){
+	
+	renderer_t* rend = (renderer_t*)param;
+	queue_cmd_t cmd;
+	frame_state_t state;
+	uint32_t* word;
+	uint32_t expected;
+	
+	while(rend->running){
 		
-				/*set pixel black*/
-				copy_pixel(&(buffer[NB_LEDS-1]),&(BLACK_PIXEL));
-				
-				/*else roll a dice to determine if a new particule needs to be spawned*/
-				if(((float)rand()/(float)RAND_MAX)>player_rate[PLAYER_2]){
-					particle_counter[END] = (PARTICLE_LENGTH-1);
-					
-				}
-			}	
-		}else{
-			blue_update_counter--;
+		/*mode changes take effect on this frame*/
+		while(cmd_queue_pop(&(rend->commands), &cmd)){
+			renderer_execute(rend, &cmd);
 		}
 		
-		/*paint the explosion, if it's exploding*/
-		if(is_exploding(buffer, explosion_location))
-			paint_explosion(buffer);
-			
-		/*push it down the SPI*/
-		res = write(spi_driver, buffer, NB_LEDS*sizeof(pixel_t));
+		if(!rend->running){
+			break;
+		}
+		
+		/*the whole frame is rendered from a single snapshot*/
+		read_game_state(&state, rend->nb_leds, render_lag_ns);
 		
-		if(res<0){
-			perror("SPI write failed");
-			fflush(stdout);
-			exit(1);
+		/*the idle mode leaves its layers black*/
+		switch(rend->mode){
+			case RENDER_PLAY:
+				render_play_frame(rend, &state);
+				break;
+			case RENDER_TRAIN:
+			case RENDER_WINNER:
+				render_train_frame(rend, &state);
+				break;
+			case RENDER_ATTRACT:
+				render_attract_frame(rend);
+				break;
 		}
 		
-		usleep(5000);	
+		render_overlay(rend, &state);
+		
+		/*add the layers in the strip and hand it over to the LED outputs*/
+		layers_composite(rend->layers, NB_LAYERS, rend->strip, rend->nb_leds);
+		led_topology_present(&led_topology, rend->strip);
+		
+		if(rend->idle){
+			/*sleep until the next frame at the idle rate, a command wakes it up*/
+			word = cmd_queue_park(&(rend->commands), &expected);
+			tick_scheduler_wait_on(&(rend->sched), word, expected);
+			cmd_queue_unpark(&(rend->commands));
+		}else{
+			tick_scheduler_wait(&(rend->sched));
+		}
 	}
 	
 	/*Turn off the LED strip*/
-	memset(buffer,0,sizeof(pixel_t)*NB_LEDS);
-	res = write(spi_driver, buffer, NB_LEDS*sizeof(pixel_t));
-	
-	if(res<0){
-		perror("SPI write failed");
-		fflush(stdout);
-		exit(1);
-	}
+	memset(rend->strip,0,sizeof(pixel_t)*rend->nb_leds);
+	led_topology_present(&led_topology, rend->strip);
 	
+	stop_led_topology(&led_topology);
+	tick_scheduler_report(&(rend->sched), "Renderer");
 	
-	usleep(1500);	
-	
-	close(spi_driver);
 	return NULL;
 }
 
-
-
-void* cereb_train_loop(void* param __attribute__((unused))){
+/**
+ * void render_play_frame(renderer_t* rend, const frame_state_t* state)
+ * @brief advance the game by one frame and render it in the layers of the
+ *        players and the explosion
+ * @param rend, reference to the renderer
+ * @param state, snapshot of the game state
+ */
+static void render_play_frame(renderer_t* rend, const frame_state_t* state){
 	
+	int location;
+	int player;
 	
-	/*define buffer*/
-	pixel_t buffer[NB_LEDS];
-	int i;
-	int spi_driver;
-	unsigned char particle_counter[2] = {0x00,0x00};
-	static uint32_t speed = 1000000;
-	int red_update_counter = DEFAULT_UPDATE_PERIOD;
-	int blue_update_counter = DEFAULT_UPDATE_PERIOD;
-	int res;
+	/*spawn new particles, at the pace of each player*/
+	for(player=0;player<NB_PLAYERS;player++){
+		
+		/*a dice is rolled each time the particles moved by one LED*/
+		rend->spawn_phase[player] += state->player_speed[player];
+		
+		if(rend->spawn_phase[player] >= Q16_ONE){
+			rend->spawn_phase[player] -= Q16_ONE;
+			
+			/*roll a dice to determine if a new particule needs to be spawned*/
+			if(particles_entry_clear(&(rend->particles[player])) && prng_next(&(rend->prng)) < SPAWN_CHANCE){
+				particles_spawn(&(rend->particles[player]), state->player_speed[player], 255);
+			}
+		}
+	}
+	
+	/*move the particles toward the explosion, both sides meet there*/
+	location = state->explosion_location;
+	particles_advance(&(rend->particles[PLAYER_1]), 0, location);
+	particles_advance(&(rend->particles[PLAYER_2]), location+1, rend->nb_leds-1);
 	
-	/*configure spi driver*/
-	spi_driver = open("/dev/spidev0.0",O_RDWR);
-	ioctl(spi_driver, SPI_IOC_WR_MAX_SPEED_HZ, &speed);	
+	render_game_layers(rend->layers, rend->nb_leds, rend->particles, location, &(rend->prng));
+}
+
+/**
+ * void render_train_frame(renderer_t* rend, const frame_state_t* state)
+ * @brief advance the training (or winner) animation by one frame and render it
+ *        in the background layer, particles leave the explosion toward both ends
+ * @param rend, reference to the renderer
+ * @param state, snapshot of the game state
+ */
+static void render_train_frame(renderer_t* rend, const frame_state_t* state){
 	
-	memset(buffer,0,sizeof(pixel_t)*NB_LEDS);
+	pixel_t* buffer;
+	pixel_t pixel;
+	int location;
+	int side;
 	
-	while(alive){
+	for(side=BEGIN;side<=END;side++){
 		
-		/************************/
-		/* RED PLAYER SIDE      */
-		/************************/
-		if(red_update_counter<=0){
-			red_update_counter = DEFAULT_UPDATE_PERIOD;
+		if(rend->train_counter[side]<=0){
+			rend->train_counter[side] = DEFAULT_UPDATE_PERIOD;
 			
-			/*from the start to explosion*/
-			for(i=NB_LEDS-2;i>=explosion_location;i--){
-				copy_pixel(&(buffer[i+1]),&(buffer[i]));
-			}
-			
-			/*check if a particle is being placed at the beginning*/
-			if(particle_counter[END]>0){
+			/*check if a particle is being placed next to the explosion*/
+			if(rend->particle_counter[side]>0){
 				
-				buffer[explosion_location+1].red = 0;
-				buffer[explosion_location+1].green = particle_kernel[particle_counter[END]];
-				buffer[explosion_location+1].blue = 0;
+				copy_train_pixel(&pixel, rend->particle_counter[side], &(rend->stream_color));
 				
-				particle_counter[END]--;
+				rend->particle_counter[side]--;
 				
 			}else{
 		
-				copy_pixel(&(buffer[0]),&(BLACK_PIXEL));
+				copy_pixel(&pixel,&(BLACK_PIXEL));
 				
 				/*else roll a dice to determine if a new particule needs to be spawned*/
-				if(((float)rand()/(float)RAND_MAX)>0.66){
-					particle_counter[END] = (PARTICLE_LENGTH-1);
-					
+				if(prng_next(&(rend->prng)) < TRAIN_SPAWN_CHANCE){
+					rend->particle_counter[side] = (PARTICLE_LENGTH-1);
 				}
-			}	
-		}else{
-			red_update_counter--;
-		}
-		
-		/************************/
-		/* BLUE PLAYER SIDE     */
-		/************************/
-		if(blue_update_counter<=0){
-			blue_update_counter = DEFAULT_UPDATE_PERIOD;
-			
-			/*from the end to explosion*/
-			/*roll back by bringing encountered values forward*/
-			for(i=1;i<explosion_location;i++){
-				copy_pixel(&(buffer[i-1]),&(buffer[i]));
 			}
 			
-			/*check if a particle is being placed at the end*/
-			if(particle_counter[BEGIN]>0){
-				
-				buffer[explosion_location-1].red = 0;
-				buffer[explosion_location-1].green = particle_kernel[particle_counter[BEGIN]];
-				buffer[explosion_location-1].blue = 0;
-				
-				particle_counter[BEGIN]--;
-			}else{
-		
-				copy_pixel(&(buffer[0]),&(BLACK_PIXEL));
-				
-				/*else roll a dice to determine if a new particule needs to be spawned*/
-				if(((float)rand()/(float)RAND_MAX)> 0.66){
-					particle_counter[BEGIN] = (PARTICLE_LENGTH-1);
-				}
-			}	
+			/*move the particles toward the end of their side*/
+			segment_push(&(rend->segment[side]), &pixel);
 		}else{
-			blue_update_counter--;
+			rend->train_counter[side]--;
 		}
+	}
+	
+	/*linearize both sides, the explosion site stays dark*/
+	location = state->explosion_location;
+	buffer = layer_begin(&(rend->layers[LAYER_BACKGROUND]), 0, rend->nb_leds-1);
+	segment_render(&(rend->segment[BEGIN]), buffer, location-1, 0, location-1);
+	segment_render(&(rend->segment[END]), buffer, location+1, location+1, rend->nb_leds-1);
+}
+
+/**
+ * void render_attract_frame(renderer_t* rend)
+ * @brief render the attract animation in the background layer, each half of
+ *        the strip glows in the color of its player, in turn
+ * @param rend, reference to the renderer
+ */
+static void render_attract_frame(renderer_t* rend){
+	
+	pixel_t* buffer;
+	pixel_t pixel;
+	int half = rend->nb_leds/2;
+	int phase;
+	int player;
+	int first;
+	int last;
+	int i;
+	uint8_t level;
+	
+	phase = rend->attract_frame%ATTRACT_PERIOD_FRAMES;
+	phase = phase<ATTRACT_PERIOD_FRAMES/2?phase:ATTRACT_PERIOD_FRAMES-phase;
+	
+	buffer = layer_begin(&(rend->layers[LAYER_BACKGROUND]), 0, rend->nb_leds-1);
+	
+	for(player=0;player<NB_PLAYERS;player++){
 		
-		/*push it down the SPI*/
-		res = write(spi_driver, buffer, NB_LEDS*sizeof(pixel_t));
+		/*the players are in opposite phase*/
+		level = (ATTRACT_LEVEL*2*(player==PLAYER_1?phase:ATTRACT_PERIOD_FRAMES/2-phase))/ATTRACT_PERIOD_FRAMES;
+		pixel.red = player_color[player].red*level/255;
+		pixel.green = player_color[player].green*level/255;
+		pixel.blue = player_color[player].blue*level/255;
 		
-		if(res<0){
-			perror("SPI write failed");
-			fflush(stdout);
-			exit(1);
+		first = player==PLAYER_1?0:half;
+		last = player==PLAYER_1?half-1:rend->nb_leds-1;
+		for(i=first;i<=last;i++){
+			copy_pixel(&(buffer[i]), &pixel);
 		}
-		
-		
-		usleep(5000);	
 	}
 	
-	/*Turn off the LED strip*/
-	memset(buffer,0,sizeof(pixel_t)*NB_LEDS);
-	res = write(spi_driver, buffer, NB_LEDS*sizeof(pixel_t));
+	rend->attract_frame++;
+}
 
-	if(res<0){
-		perror("SPI write failed");
-		fflush(stdout);
-		exit(1);
-	}
+/**
+ * void renderer_set_idle(renderer_t* rend)
+ * @brief tick at the idle rate in the idle and attract modes, at the frame rate
+ *        otherwise, and the LED writers with the renderer
+ * @param rend, reference to the renderer
+ */
+static void renderer_set_idle(renderer_t* rend){
 	
-	usleep(1500);	
+	char idle = (rend->mode == RENDER_IDLE || rend->mode == RENDER_ATTRACT);
 	
-	close(spi_driver);
+	if(idle != rend->idle){
+		rend->idle = idle;
+		tick_scheduler_set_rate(&(rend->sched), idle?IDLE_FRAME_RATE:FRAME_RATE);
+		led_topology_set_idle(&led_topology, idle);
+	}
+}
+
+/**
+ * void render_overlay(renderer_t* rend, const frame_state_t* state)
+ * @brief paint the effect being played in the overlay layer, or the flash of
+ *        the winner's color in winner mode
+ * @param rend, reference to the renderer
+ * @param state, snapshot of the game state
+ */
+static void render_overlay(renderer_t* rend, const frame_state_t* state){
+	
+	led_layer_t* overlay = &(rend->layers[LAYER_OVERLAY]);
+	pixel_t* buffer;
+	pixel_t pixel;
+	int seconds_left;
+	int second_frame;
+	int first;
+	int phase;
+	int i;
+	uint8_t level;
 	
-	return NULL;
+	if(rend->effect == EFFECT_FLASH){
+		
+		/*white flash, fading out*/
+		level = 255-(255*rend->effect_frame)/rend->effect_length;
+		buffer = layer_begin(overlay, 0, rend->nb_leds-1);
+		memset(buffer, level, rend->nb_leds*sizeof(pixel_t));
+	}
+	else if(rend->effect == EFFECT_COUNTDOWN){
+		
+		/*a mark per second left around the explosion site, fading within each second*/
+		seconds_left = (rend->effect_length-rend->effect_frame+FRAMES_PER_SECOND-1)/FRAMES_PER_SECOND;
+		second_frame = rend->effect_frame%FRAMES_PER_SECOND;
+		level = 255-((255-COUNTDOWN_MIN_LEVEL)*second_frame)/FRAMES_PER_SECOND;
+		
+		first = state->explosion_location-(seconds_left-1)*COUNTDOWN_SPACING/2;
+		buffer = layer_begin(overlay, first, first+(seconds_left-1)*COUNTDOWN_SPACING);
+		for(i=0;i<seconds_left;i++){
+			if(first+i*COUNTDOWN_SPACING>=0 && first+i*COUNTDOWN_SPACING<rend->nb_leds){
+				copy_explosion_pixel(&(buffer[first+i*COUNTDOWN_SPACING]), level);
+			}
+		}
+	}
+	else if(rend->mode == RENDER_WINNER){
+		
+		/*the strip pulses at the winner's color, under its particles*/
+		phase = rend->effect_frame%WINNER_PULSE_FRAMES;
+		phase = phase<WINNER_PULSE_FRAMES/2?phase:WINNER_PULSE_FRAMES-phase;
+		level = (WINNER_PULSE_LEVEL*2*phase)/WINNER_PULSE_FRAMES;
+		
+		pixel.red = player_color[rend->winner].red*level/255;
+		pixel.green = player_color[rend->winner].green*level/255;
+		pixel.blue = player_color[rend->winner].blue*level/255;
+		
+		buffer = layer_begin(overlay, 0, rend->nb_leds-1);
+		for(i=0;i<rend->nb_leds;i++){
+			copy_pixel(&(buffer[i]), &pixel);
+		}
+		
+		rend->effect_frame++;
+		return;
+	}
+	else{
+		layer_clear(overlay);
+		return;
+	}
 	
+	if(++rend->effect_frame >= rend->effect_length){
+		rend->effect = NO_EFFECT;
+		rend->effect_frame = 0;
+	}
 }
-
-
-
-
-
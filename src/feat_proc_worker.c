@@ -0,0 +1,235 @@
+/**
+ * @file feat_proc_worker.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Long-lived feature processing thread. It is created once and is told 
+ * to train the players or to sample them continuously, instead of creating
+ * threads on every game tick. In sampling mode, each normalized sample is 
+ * published in the player's feat_proc_t as soon as its frame arrives.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "feat_proc_worker.h"
+
+static void* feat_proc_worker_loop(void* param);
+static int worker_train_frame(int player, void* param);
+static int worker_sample_frame(int player, void* param);
+static int feat_proc_worker_set_mode(feat_proc_worker_t* worker, char mode);
+
+/**
+ * int start_feat_proc_worker(feat_proc_worker_t* worker, feature_input_mux_t* input_mux, feat_proc_t* feature_proc)
+ * @brief create the worker thread, it waits in idle mode
+ * @param worker, reference to the worker
+ * @param input_mux, mux over the players' feature inputs
+ * @param feature_proc, array of feature processing, one per input of the mux
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int start_feat_proc_worker(feat_proc_worker_t* worker, feature_input_mux_t* input_mux, feat_proc_t* feature_proc){
+	
+	worker->input_mux = input_mux;
+	worker->feature_proc = feature_proc;
+	worker->mode = WORKER_IDLE;
+	worker->busy = 0x00;
+	worker->status = EXIT_SUCCESS;
+	
+	pthread_mutex_init(&(worker->lock), NULL);
+	pthread_cond_init(&(worker->cond), NULL);
+	
+	if(pthread_create(&(worker->thread), NULL, feat_proc_worker_loop, (void*)worker) != 0){
+		perror("feature processing worker");
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feat_proc_worker_train(feat_proc_worker_t* worker)
+ * @brief blocking call, trains every player
+ * @param worker, reference to the worker
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_proc_worker_train(feat_proc_worker_t* worker){
+	
+	int status;
+	
+	pthread_mutex_lock(&(worker->lock));
+	worker->mode = WORKER_TRAIN;
+	worker->busy = 0x01;
+	pthread_cond_broadcast(&(worker->cond));
+	
+	/*the worker goes back to idle once done*/
+	while(worker->busy){
+		pthread_cond_wait(&(worker->cond), &(worker->lock));
+	}
+	status = worker->status;
+	pthread_mutex_unlock(&(worker->lock));
+	
+	return status;
+}
+
+/**
+ * int feat_proc_worker_sample(feat_proc_worker_t* worker)
+ * @brief start publishing samples, returns right away
+ * @param worker, reference to the worker
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_proc_worker_sample(feat_proc_worker_t* worker){
+	return feat_proc_worker_set_mode(worker, WORKER_SAMPLE);
+}
+
+/**
+ * int feat_proc_worker_idle(feat_proc_worker_t* worker)
+ * @brief stop sampling, returns once the inputs are left alone
+ * @param worker, reference to the worker
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_proc_worker_idle(feat_proc_worker_t* worker){
+	return feat_proc_worker_set_mode(worker, WORKER_IDLE);
+}
+
+/**
+ * int stop_feat_proc_worker(feat_proc_worker_t* worker)
+ * @brief terminate the worker thread
+ * @param worker, reference to the worker
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int stop_feat_proc_worker(feat_proc_worker_t* worker){
+	
+	feat_proc_worker_set_mode(worker, WORKER_EXIT);
+	pthread_join(worker->thread, NULL);
+	
+	pthread_mutex_destroy(&(worker->lock));
+	pthread_cond_destroy(&(worker->cond));
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feat_proc_worker_set_mode(feat_proc_worker_t* worker, char mode)
+ * @brief request a mode, waits for the current one to complete if the 
+ *        worker must stop using the inputs
+ * @return status of the worker
+ */
+static int feat_proc_worker_set_mode(feat_proc_worker_t* worker, char mode){
+	
+	int status;
+	
+	pthread_mutex_lock(&(worker->lock));
+	
+	worker->mode = mode;
+	if(mode != WORKER_IDLE && mode != WORKER_EXIT){
+		worker->busy = 0x01;
+	}
+	pthread_cond_broadcast(&(worker->cond));
+	
+	/*the mode being run ends, even if an input stalled*/
+	feat_mux_interrupt(worker->input_mux);
+	
+	if(mode == WORKER_IDLE){
+		while(worker->busy){
+			pthread_cond_wait(&(worker->cond), &(worker->lock));
+		}
+	}
+	status = worker->status;
+	
+	pthread_mutex_unlock(&(worker->lock));
+	
+	return status;
+}
+
+/**
+ * void* feat_proc_worker_loop(void* param)
+ * @brief worker thread, runs the requested mode on the input mux
+ * @param param, (feat_proc_worker_t*) reference to the worker
+ * @return NULL
+ */
+static void* feat_proc_worker_loop(void* param){
+	
+	feat_proc_worker_t* worker = param;
+	char mode;
+	int status = EXIT_SUCCESS;
+	
+	pthread_mutex_lock(&(worker->lock));
+	
+	while(worker->mode != WORKER_EXIT){
+		
+		/*wait for something to do*/
+		if(worker->mode == WORKER_IDLE){
+			pthread_cond_wait(&(worker->cond), &(worker->lock));
+			continue;
+		}
+		
+		/*a mode requested from now on interrupts the run*/
+		feat_mux_clear_interrupt(worker->input_mux);
+		mode = worker->mode;
+		pthread_mutex_unlock(&(worker->lock));
+		
+		/*the pages published while idle are stale*/
+		feat_mux_release(worker->input_mux);
+		
+		if(mode == WORKER_TRAIN){
+			status = feat_mux_run(worker->input_mux, worker_train_frame, (void*)worker);
+		}else if(mode == WORKER_SAMPLE){
+			/*runs until interrupted by the next mode*/
+			status = feat_mux_run(worker->input_mux, worker_sample_frame, (void*)worker);
+		}
+		
+		if(status != EXIT_SUCCESS){
+			fprintf(stderr, "Feature processing worker: feature input error\n");
+		}
+		
+		/*the inputs are parked until the next mode, nothing is read meanwhile*/
+		feat_mux_release(worker->input_mux);
+		
+		pthread_mutex_lock(&(worker->lock));
+		worker->status = status;
+		worker->busy = 0x00;
+		
+		/*a completed mode goes back to idle, unless another was requested meanwhile*/
+		if(worker->mode == mode){
+			worker->mode = WORKER_IDLE;
+		}
+		pthread_cond_broadcast(&(worker->cond));
+	}
+	
+	worker->busy = 0x00;
+	pthread_mutex_unlock(&(worker->lock));
+	
+	return NULL;
+}
+
+/**
+ * int worker_train_frame(int player, void* param)
+ * @brief mux handler, trains a player with the frame that has just arrived
+ * @param player, index of the player
+ * @param param, (feat_proc_worker_t*) reference to the worker
+ * @return MUX_INPUT_MORE until the player is trained
+ */
+static int worker_train_frame(int player, void* param){
+	
+	feat_proc_worker_t* worker = param;
+	
+	if(train_feat_processing_frame(&(worker->feature_proc[player])) == FEAT_PROC_MORE){
+		return MUX_INPUT_MORE;
+	}
+	return MUX_INPUT_DONE;
+}
+
+/**
+ * int worker_sample_frame(int player, void* param)
+ * @brief mux handler, publishes a sample for a player from the frame that has just arrived
+ * @param player, index of the player
+ * @param param, (feat_proc_worker_t*) reference to the worker
+ * @return MUX_INPUT_MORE, the mux is interrupted when the mode changes
+ */
+static int worker_sample_frame(int player, void* param){
+	
+	feat_proc_worker_t* worker = param;
+	
+	normalize_sample_frame(&(worker->feature_proc[player]));
+	return MUX_INPUT_MORE;
+}
@@ -16,48 +16,42 @@
 #include "xml.h"
 
 /**
- * int init_feature_input(char input_type)
+ * int init_feature_input(char input_type, feature_input_t* feature_input)
  * 
- * @brief Setup function pointers for the data input based on the type
- * of data source which could be shared memory (SHM) or a fake signal generator
- * (FAKE).
- * @param input_type, string identifying the type of input to init
+ * @brief Select the backend operations for the data input based on the type
+ * of data source which could be shared memory with semaphores (SHM) or with the
+ * futex ring (SHM_RING), or a fake signal generator (FAKE) and initialize it. The selection is kept in the feature input itself,
+ * such that each player can use its own source.
+ * @param input_type, identifier of the type of input to init
+ * @param feature_input, feature input to initialize
  * @return EXIT_FAILURE for unknown type, EXIT_SUCCESS for known/success
  */
 int init_feature_input(char input_type, feature_input_t* feature_input){
 
 	/*default values*/
-	_INIT_FEAT_INPUT_FC = NULL;
-	_REQUEST_FEAT_FC = NULL;
-	_WAIT_FEAT_FC = NULL;
-	_TERMINATE_FEAT_INPUT_FC = NULL;
+	feature_input->ops = NULL;
+	feature_input->page_held = 0x00;
+	feature_input->nb_pages = 0;
+	feature_input->nb_syscalls = 0;
 
 	/*shared memory interface*/
 	if(input_type == SHM_INPUT) {
-		
-		printf("Input source: SHM\n");
-		_INIT_FEAT_INPUT_FC = &shm_rd_init;
-		_REQUEST_FEAT_FC = &shm_rd_request;
-		_WAIT_FEAT_FC = &shm_rd_wait_for_request_completed;
-		_GET_FRAME_INFO_FC = &shm_get_frame_info_ref;
-		_GET_FVECT_INFO_FC = &shm_get_feature_array_ref;
-		_TERMINATE_FEAT_INPUT_FC = &shm_rd_cleanup;
+		feature_input->ops = &shm_rd_ops;
+	}
+	/*shared memory ring interface*/
+	else if(input_type == SHM_RING_INPUT) {
+		feature_input->ops = &shm_ring_ops;
 	}
 	/*fake input interface*/
 	else if(input_type == FAKE_INPUT){
-		printf("Input source: FAKE\n");
-		_INIT_FEAT_INPUT_FC = &fake_feat_gen_init;
-		_REQUEST_FEAT_FC = &fake_feat_gen_request;
-		_WAIT_FEAT_FC = &fake_feat_gen_wait_for_request_completed;
-		_GET_FRAME_INFO_FC = &fake_feat_gen_frame_info_ref;
-		_GET_FVECT_INFO_FC = &fake_feat_gen_feature_array_ref;
-		_TERMINATE_FEAT_INPUT_FC = &fake_feat_gen_cleanup;
+		feature_input->ops = &fake_feat_gen_ops;
 	}
 	else{
 		fprintf(stderr, "Unknown input type\n");
 		return EXIT_FAILURE;
 	}
+	
+	printf("Input source: %s\n", feature_input->ops->name);
 	return INIT_FEAT_INPUT_FC(feature_input);
 	
 }
-
@@ -0,0 +1,336 @@
+/**
+ * @file feature_input_mux.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Multiplexed wait on the feature inputs of all players. A single thread
+ * requests a page on each input and dispatches the pages as they arrive,
+ * instead of one blocking thread per input.
+ * 
+ * When all the pending inputs provide a futex word (SHM_RING, and SHM through
+ * its waiter thread), the mux sleeps on all of them at once with futex_waitv.
+ * When a single input is pending and it can't be slept on, its blocking wait is
+ * used. Otherwise (FAKE), the inputs are polled every MUX_POLL_PERIOD_NS.
+ * 
+ * Another thread can interrupt the mux at any time, the wake word of the mux
+ * is slept on along with the inputs, such that a stalled input can't hold it.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "feature_input_mux.h"
+
+/*kernel headers older than 5.16 lack futex_waitv, the kernel may still have it*/
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449 /*same number on every architecture*/
+#endif
+
+#ifndef FUTEX_32
+#define FUTEX_32 2
+
+struct futex_waitv{
+	uint64_t val;
+	uint64_t uaddr;
+	uint32_t flags;
+	uint32_t __reserved;
+};
+#endif
+
+static int feat_mux_sleep(feature_input_mux_t* mux);
+static int feat_mux_complete(feature_input_mux_t* mux, int input_id, mux_handler_t handler, void *param);
+
+/**
+ * int feat_mux_init(feature_input_mux_t* mux, feature_input_t* inputs, int nb_inputs)
+ * @brief initialize the mux over an array of initialized feature inputs
+ * @param mux, reference to the mux
+ * @param inputs, array of feature inputs
+ * @param nb_inputs, number of feature inputs
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_mux_init(feature_input_mux_t* mux, feature_input_t* inputs, int nb_inputs){
+	
+	int i;
+	
+	if(nb_inputs > MUX_MAX_INPUTS){
+		fprintf(stderr, "Input mux: too many inputs (%i)\n", nb_inputs);
+		return EXIT_FAILURE;
+	}
+	
+	memset(mux, 0, sizeof(feature_input_mux_t));
+	mux->nb_inputs = nb_inputs;
+	
+	for(i=0;i<nb_inputs;i++){
+		mux->inputs[i] = &(inputs[i]);
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feat_mux_request(feature_input_mux_t* mux, int input_id)
+ * @brief request a page on an input, it will be dispatched when it arrives
+ * @param mux, reference to the mux
+ * @param input_id, index of the input
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_mux_request(feature_input_mux_t* mux, int input_id){
+	
+	if(REQUEST_FEAT_FC(mux->inputs[input_id]) != EXIT_SUCCESS){
+		return EXIT_FAILURE;
+	}
+	
+	mux->pending[input_id] = 0x01;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feat_mux_dispatch(feature_input_mux_t* mux, mux_handler_t handler, void *param)
+ * @brief blocking call, until at least one of the pending inputs has a page. The handler
+ *        is called for each page that arrived and, if it returns MUX_INPUT_MORE, 
+ *        a new page is requested on that input.
+ * @param mux, reference to the mux
+ * @param handler, called for each page
+ * @param param, passed to the handler
+ * @return number of pages dispatched, 0 if interrupted, -1 on error or if nothing is pending
+ */
+int feat_mux_dispatch(feature_input_mux_t* mux, mux_handler_t handler, void *param){
+	
+	int i;
+	int res;
+	int nb_pending;
+	int last_pending = 0;
+	int nb_dispatched;
+	
+	while(1){
+		
+		nb_pending = 0;
+		nb_dispatched = 0;
+		
+		/*dispatch whatever has arrived*/
+		for(i=0;i<mux->nb_inputs;i++){
+			
+			if(!mux->pending[i]){
+				continue;
+			}
+			
+			res = POLL_FEAT_FC(mux->inputs[i]);
+			
+			if(res == EXIT_SUCCESS){
+				if(feat_mux_complete(mux, i, handler, param) != EXIT_SUCCESS){
+					return -1;
+				}
+				nb_dispatched++;
+			}else if(res == FEAT_INPUT_PENDING){
+				nb_pending++;
+				last_pending = i;
+			}else{
+				return -1;
+			}
+		}
+		
+		if(nb_dispatched > 0){
+			return nb_dispatched;
+		}
+		
+		if(nb_pending == 0){
+			return -1;
+		}
+		
+		if(__atomic_load_n(&(mux->interrupted), __ATOMIC_ACQUIRE)){
+			return 0;
+		}
+		
+		/*a single input that can't be slept on, use its own blocking wait*/
+		if(nb_pending == 1 && mux->inputs[last_pending]->ops->park == NULL){
+			mux->nb_sleeps++;
+			if(WAIT_FEAT_FC(mux->inputs[last_pending]) != EXIT_SUCCESS){
+				return -1;
+			}
+			if(feat_mux_complete(mux, last_pending, handler, param) != EXIT_SUCCESS){
+				return -1;
+			}
+			return 1;
+		}
+		
+		if(feat_mux_sleep(mux) != EXIT_SUCCESS){
+			return -1;
+		}
+	}
+}
+
+/**
+ * int feat_mux_run(feature_input_mux_t* mux, mux_handler_t handler, void *param)
+ * @brief request a page on every input and dispatch the pages until the handler
+ *        returned MUX_INPUT_DONE for all of them, or the mux is interrupted. The
+ *        inputs still pending are left as is, see feat_mux_release.
+ * @param mux, reference to the mux
+ * @param handler, called for each page
+ * @param param, passed to the handler
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int feat_mux_run(feature_input_mux_t* mux, mux_handler_t handler, void *param){
+	
+	int i;
+	char running = 0x01;
+	
+	for(i=0;i<mux->nb_inputs;i++){
+		if(feat_mux_request(mux, i) != EXIT_SUCCESS){
+			return EXIT_FAILURE;
+		}
+	}
+	
+	while(running && !__atomic_load_n(&(mux->interrupted), __ATOMIC_ACQUIRE)){
+		
+		if(feat_mux_dispatch(mux, handler, param) < 0){
+			return EXIT_FAILURE;
+		}
+		
+		running = 0x00;
+		for(i=0;i<mux->nb_inputs;i++){
+			running |= mux->pending[i];
+		}
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void feat_mux_release(feature_input_mux_t* mux)
+ * @brief stop tracking the inputs, and release the pages they hold and the
+ *        ones published since, see the release operation of the inputs
+ * @param mux, reference to the mux
+ */
+void feat_mux_release(feature_input_mux_t* mux){
+	
+	int i;
+	
+	for(i=0;i<mux->nb_inputs;i++){
+		
+		mux->pending[i] = 0x00;
+		
+		if(mux->inputs[i]->ops->release != NULL){
+			mux->inputs[i]->ops->release(mux->inputs[i]);
+		}
+	}
+}
+
+/**
+ * void feat_mux_interrupt(feature_input_mux_t* mux)
+ * @brief make feat_mux_run return as soon as possible, even while waiting on
+ *        an input, until feat_mux_clear_interrupt. Called from another thread.
+ * @param mux, reference to the mux
+ */
+void feat_mux_interrupt(feature_input_mux_t* mux){
+	
+	__atomic_store_n(&(mux->interrupted), 0x01, __ATOMIC_RELEASE);
+	
+	/*the kernel checks the word again, so a mux going to sleep can't miss it*/
+	__atomic_add_fetch(&(mux->wake_word), 1, __ATOMIC_SEQ_CST);
+	syscall(SYS_futex, &(mux->wake_word), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * void feat_mux_clear_interrupt(feature_input_mux_t* mux)
+ * @brief let the mux wait on its inputs again, must be called before deciding
+ *        to run it, such that an interrupt issued meanwhile is not lost
+ * @param mux, reference to the mux
+ */
+void feat_mux_clear_interrupt(feature_input_mux_t* mux){
+	__atomic_store_n(&(mux->interrupted), 0x00, __ATOMIC_RELEASE);
+}
+
+/**
+ * int feat_mux_complete(feature_input_mux_t* mux, int input_id, mux_handler_t handler, void *param)
+ * @brief hand an arrived page to the handler and request the next one if needed
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+static int feat_mux_complete(feature_input_mux_t* mux, int input_id, mux_handler_t handler, void *param){
+	
+	mux->pending[input_id] = 0x00;
+	mux->nb_dispatched++;
+	
+	if(handler(input_id, param) == MUX_INPUT_MORE){
+		return feat_mux_request(mux, input_id);
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feat_mux_sleep(feature_input_mux_t* mux)
+ * @brief sleep until one of the pending inputs might have a page
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+static int feat_mux_sleep(feature_input_mux_t* mux){
+	
+	struct timespec poll_period = {0, MUX_POLL_PERIOD_NS};
+	uint32_t wake_expected;
+	int i;
+	struct futex_waitv waiters[MUX_MAX_INPUTS+1];
+	uint32_t expected;
+	int nb_waiters = 0;
+	char can_wait = !mux->no_waitv;
+	
+	mux->nb_sleeps++;
+	
+	/*read before checking the flag, an interrupt changes it after setting the flag*/
+	wake_expected = __atomic_load_n(&(mux->wake_word), __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&(mux->interrupted), __ATOMIC_ACQUIRE)){
+		return EXIT_SUCCESS;
+	}
+	
+	/*all the pending inputs must be able to wake us up*/
+	for(i=0;i<mux->nb_inputs;i++){
+		if(mux->pending[i] && mux->inputs[i]->ops->park == NULL){
+			can_wait = 0x00;
+		}
+	}
+	
+	if(can_wait){
+		
+		memset(waiters, 0, sizeof(waiters));
+		
+		for(i=0;i<mux->nb_inputs;i++){
+			if(mux->pending[i]){
+				waiters[nb_waiters].uaddr = (uintptr_t)mux->inputs[i]->ops->park(mux->inputs[i], &expected);
+				waiters[nb_waiters].val = expected;
+				/*shared between processes, so not private*/
+				waiters[nb_waiters].flags = FUTEX_32;
+				nb_waiters++;
+			}
+		}
+		
+		/*and on interrupts*/
+		waiters[nb_waiters].uaddr = (uintptr_t)&(mux->wake_word);
+		waiters[nb_waiters].val = wake_expected;
+		waiters[nb_waiters].flags = FUTEX_32;
+		nb_waiters++;
+		
+		/*returns right away if one of the words has already changed, ENOSYS before Linux 5.16*/
+		if(syscall(SYS_futex_waitv, waiters, nb_waiters, 0, NULL, CLOCK_MONOTONIC) < 0 &&
+		   errno == ENOSYS){
+			mux->no_waitv = 0x01;
+		}
+		
+		for(i=0;i<mux->nb_inputs;i++){
+			if(mux->pending[i]){
+				mux->inputs[i]->ops->unpark(mux->inputs[i]);
+			}
+		}
+		
+		if(!mux->no_waitv){
+			return EXIT_SUCCESS;
+		}
+	}
+	
+	/*poll again later, or when interrupted*/
+	syscall(SYS_futex, &(mux->wake_word), FUTEX_WAIT, wake_expected, &poll_period, NULL, 0);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file feature_layout.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Layout of the feature vector, from the features selected in the
+ * configuration. The size of the pages of the feature input and the position
+ * of the bins measured both come from it, such that they always agree.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "feature_layout.h"
+
+#define BIN_TOLERANCE 1e-6 /*of a bin, for band edges falling on a bin*/
+
+static void add_section(feature_layout_t* layout, feature_section_t* section, char present, int width);
+
+/**
+ * int init_feature_layout(feature_layout_t* layout, const appconfig_t* app_config)
+ * @brief lay out the sections of the feature vector selected in the configuration
+ * @param layout, layout to initialize
+ * @param app_config, configuration of the app
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the vector is empty
+ */
+int init_feature_layout(feature_layout_t* layout, const appconfig_t* app_config){
+	
+	layout->nb_channels = app_config->nb_channels;
+	layout->nb_features = 0;
+	layout->hz_per_bin = app_config->sample_rate/app_config->window_width;
+	
+	/*time series, the whole window*/
+	add_section(layout, &(layout->timeseries), app_config->timeseries, app_config->window_width);
+	
+	/*one-sided Fourier transform, half the window*/
+	add_section(layout, &(layout->fft), app_config->fft, app_config->window_width/2);
+	
+	/*EEG power bands, a single value*/
+	add_section(layout, &(layout->power_alpha), app_config->power_alpha, 1);
+	add_section(layout, &(layout->power_beta), app_config->power_beta, 1);
+	add_section(layout, &(layout->power_gamma), app_config->power_gamma, 1);
+	
+	if(layout->nb_features <= 0){
+		fprintf(stderr, "Feature layout: no feature selected\n");
+		return EXIT_FAILURE;
+	}
+	
+	if(app_config->debug){
+		printf("Feature layout: %i features, %i channels", layout->nb_features, layout->nb_channels);
+		if(layout->fft.offset >= 0){
+			printf(", FFT at %i, %i bins per channel of %.2f Hz", layout->fft.offset, layout->fft.width,
+				   layout->hz_per_bin);
+		}
+		printf("\n");
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int feature_layout_band(const feature_layout_t* layout, int channel, double low_hz, double high_hz, band_gather_t* gather)
+ * @brief look up the FFT bins of a band for one channel
+ * @param layout, layout of the feature vector
+ * @param channel, index of the channel
+ * @param low_hz, lowest frequency of the band (included)
+ * @param high_hz, highest frequency of the band (included)
+ * @param (out)gather, indices of the bins in the feature vector
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the band is not in the feature vector
+ */
+int feature_layout_band(const feature_layout_t* layout, int channel, double low_hz, double high_hz, band_gather_t* gather){
+	
+	int first;
+	int last;
+	int bin;
+	
+	gather->nb_bins = 0;
+	
+	if(layout->fft.offset < 0){
+		fprintf(stderr, "Feature layout: the FFT is required\n");
+		return EXIT_FAILURE;
+	}
+	
+	if(channel < 0 || channel >= layout->nb_channels){
+		fprintf(stderr, "Feature layout: no channel %i, %i configured\n", channel, layout->nb_channels);
+		return EXIT_FAILURE;
+	}
+	
+	first = (int)ceil(low_hz/layout->hz_per_bin-BIN_TOLERANCE);
+	last = (int)floor(high_hz/layout->hz_per_bin+BIN_TOLERANCE);
+	
+	if(first < 0 || last >= layout->fft.width || last < first || last-first+1 > MAX_BAND_BINS){
+		fprintf(stderr, "Feature layout: band %.1f-%.1f Hz not within the FFT, %i bins of %.2f Hz\n",
+				low_hz, high_hz, layout->fft.width, layout->hz_per_bin);
+		return EXIT_FAILURE;
+	}
+	
+	for(bin=first;bin<=last;bin++){
+		gather->index[gather->nb_bins++] = layout->fft.offset+channel*layout->fft.width+bin;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void add_section(feature_layout_t* layout, feature_section_t* section, char present, int width)
+ * @brief add a section at the end of the feature vector, if it is present
+ * @param layout, layout of the feature vector
+ * @param section, section to add
+ * @param present, the section is selected
+ * @param width, features per channel
+ */
+static void add_section(feature_layout_t* layout, feature_section_t* section, char present, int width){
+	
+	if(!present){
+		section->offset = -1;
+		section->width = 0;
+		return;
+	}
+	
+	section->offset = layout->nb_features;
+	section->width = width;
+	layout->nb_features += width*layout->nb_channels;
+}
@@ -6,7 +6,15 @@
  * It needs to be trained to form a reference frame and then it can be used to 
  * produce normalized sample.
  * 
- * The strategy is simple, it z-transform samples 
+ * The strategy is simple, it z-transform samples. The mean and standard deviation
+ * of the reference are accumulated as the training samples arrive, nothing is buffered.
+ * A player with a stored profile is only verified on a few samples, the training
+ * carries on in full if they disagree with it.
+ *
+ * During the game, the reference may follow the drift of the electrodes with
+ * exponentially weighted statistics. The samples far from the reference, as
+ * when the player makes an effort, are left out, and the reference is kept
+ * within bounds of the trained one.
 */
 
 #include <stdio.h>
@@ -17,31 +25,53 @@
 #include "feature_processing.h"
 #include "feature_input.h"
 
-#include <stats.h>
-
-#define NB_CHANNELS_USED 2
 #define NB_PACKETS_DROPPED 3
 
-/*navigation in feature vector*/
-#define FEAT_IDX_START 4
-#define FEAT_IDX_SECOND 5
-#define FEAT_IDX_END 7
-#define CHANNEL_WIDTH 55
-#define SECOND_CHANNEL_OFFSET 3*CHANNEL_WIDTH
+/*measurement, alpha band of the left and right temporal channels*/
+#define MEASURE_BAND_LOW 8.0	/*Hz */
+#define MEASURE_BAND_HIGH 12.0	/*Hz */
+#define MEASURE_LEFT_CHANNEL 0
+#define MEASURE_RIGHT_CHANNEL 3
 
 
-void get_peak_from_channels(double *max_left, double *max_right, double *feature_array);
-void get_mean_from_channels(double *mean_left, double *mean_right, double *feature_array);
+static int training_converged(feat_proc_t * feature_proc);
+static void start_reference(feat_proc_t * feature_proc);
+static void adapt_reference(feat_proc_t * feature_proc, const double *raw, const double *features);
+void get_peak_from_channels(feat_proc_t * feature_proc, double *max_left, double *max_right,
+			    double *feature_array);
+void get_mean_from_channels(feat_proc_t * feature_proc, double *mean_left, double *mean_right,
+			    double *feature_array);
 
 /**
  * int init_feat_processing(feat_proc_t* feature_proc)
- * @brief initialize the feature processing 
+ * @brief initialize the feature processing, resets the training statistics and
+ * looks up the bins measured in the layout of the feature vector
  * @param feature_proc, pointer to feature processing
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-int init_feat_processing(feat_proc_t * feature_proc __attribute__ ((unused)))
+int init_feat_processing(feat_proc_t * feature_proc)
 {
 
+	if (feature_layout_band(feature_proc->layout, MEASURE_LEFT_CHANNEL, MEASURE_BAND_LOW,
+				MEASURE_BAND_HIGH, &(feature_proc->band[0])) == EXIT_FAILURE
+	    || feature_layout_band(feature_proc->layout, MEASURE_RIGHT_CHANNEL, MEASURE_BAND_LOW,
+				   MEASURE_BAND_HIGH, &(feature_proc->band[1])) == EXIT_FAILURE) {
+		return EXIT_FAILURE;
+	}
+
+	feature_proc->nb_packets_dropped = 0;
+	feature_proc->verifying = feature_proc->baseline != NULL;
+	feature_proc->warm_started = 0;
+
+	/*no training sample yet */
+	seqlock_init(&(feature_proc->train_lock));
+	running_stats_init(&(feature_proc->train_stats), NB_CHANNELS_USED);
+
+	/*no sample yet */
+	seqlock_init(&(feature_proc->sample_lock));
+	feature_proc->sample = 0.0;
+	feature_proc->sample_nb = 0;
+
 	return EXIT_SUCCESS;
 }
 
@@ -52,169 +82,388 @@ int init_feat_processing(feat_proc_t * feature_proc __attribute__ ((unused)))
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
 void train_feat_processing(feat_proc_t * feature_proc)
+{
+
+	do {
+		/*log the next sample */
+		REQUEST_FEAT_FC(feature_proc->feature_input);
+		WAIT_FEAT_FC(feature_proc->feature_input);
+
+	} while (train_feat_processing_frame(feature_proc) == FEAT_PROC_MORE);
+}
+
+/**
+ * int train_feat_processing_frame(feat_proc_t* feature_proc)
+ * @brief add the frame that has just arrived on the feature input to the training
+ * statistics, the reference is set as soon as the estimates have converged or
+ * the last sample is in
+ * @param feature_proc, pointer to feature processing
+ * @return FEAT_PROC_DONE once trained, FEAT_PROC_MORE if more frames are required
+ */
+int train_feat_processing_frame(feat_proc_t * feature_proc)
 {
 
 	int i = 0;
+	running_stats_t *train_stats = &(feature_proc->train_stats);
 
 	/*pointers to the feature array */
 	frame_info_t *frame_info;
 	double *feature_array;
-
-	double *training_set = (double *)malloc(feature_proc->nb_train_samples * NB_CHANNELS_USED * sizeof(double));
-
-	if (training_set == NULL) {
-		printf("Training_set malloc() may have failed OR is NULL\n - may function not as intented\n");
-	}
-
-	double mean_left = 0.0;
-	double mean_right = 0.0;
+	double features[NB_CHANNELS_USED];
 
 	/*drop first NB_PACKETS_DROPPED packets to prevent errors */
 	/*(empirical observation, should be fixed in data_interface in a later release) */
-	for (i = 0; i < NB_PACKETS_DROPPED; i++) {
-		REQUEST_FEAT_FC(feature_proc->feature_input);
-		WAIT_FEAT_FC(feature_proc->feature_input);
+	if (feature_proc->nb_packets_dropped < NB_PACKETS_DROPPED) {
+		feature_proc->nb_packets_dropped++;
+		return FEAT_PROC_MORE;
 	}
 
-	/*start acquisition */
-	i = 0;
-	while (i < feature_proc->nb_train_samples) {
+	/*get reference on current frame info */
+	frame_info = GET_FRAME_INFO_FC(feature_proc->feature_input);
+	/*get reference on current feature array */
+	feature_array = GET_FVECT_INFO_FC(feature_proc->feature_input);
 
-		/*log the next sequence of samples */
-		REQUEST_FEAT_FC(feature_proc->feature_input);
-		WAIT_FEAT_FC(feature_proc->feature_input);
+	/*check if there is an eye blink in the sample */
+	if (frame_info->eye_blink_detected) {
+		printf("Frame invalid: ");
+		printf("Eye blink detected\n");
+		return FEAT_PROC_MORE;
+	}
 
-		/*get reference on current frame info */
-		frame_info = GET_FRAME_INFO_FC(feature_proc->feature_input);
-		/*get reference on current feature array */
-		feature_array = GET_FVECT_INFO_FC(feature_proc->feature_input);
+	/*parse feature array to find peak values around 10Hz */
+	get_mean_from_channels(feature_proc, &features[0], &features[1], feature_array);
 
-		/*check if there is an eye blink in the sample */
-		if (!frame_info->eye_blink_detected) {
-			/*parse feature array to find peak values around 10Hz */
-			get_mean_from_channels(&mean_left, &mean_right, feature_array);
+	/*accumulate the two alpha wave samples */
+	seqlock_write_begin(&(feature_proc->train_lock));
+	running_stats_add(train_stats, features);
+	seqlock_write_end(&(feature_proc->train_lock));
 
-			/*pick the two alpha wave samples */
-			training_set[i * 2] = mean_left;
-			training_set[i * 2 + 1] = mean_right;
+	if ((train_stats->n - 1) % 5 == 0) {
+		printf("training progress: %.1f\n",
+		       (float)(train_stats->n - 1) / (float)feature_proc->nb_train_samples * 100);
+		fflush(stdout);
+	}
 
-			if (i % 5 == 0) {
-				printf("training progress: %.1f\n",
-				       (float)i / (float)feature_proc->nb_train_samples * 100);
-				fflush(stdout);
-			}
-			i++;
-		} else {
-			printf("Frame invalid: ");
-			if (frame_info->eye_blink_detected) {
-				printf("Eye blink detected\n");
+	/*a returning player is verified first, the samples count toward the training if it fails */
+	if (feature_proc->verifying) {
+		if (train_stats->n < (unsigned int)feature_proc->nb_verify_samples) {
+			return FEAT_PROC_MORE;
+		}
+		feature_proc->verifying = 0;
+
+		if (calib_profile_verify(feature_proc->baseline, train_stats,
+					 feature_proc->verify_tolerance)) {
+			for (i = 0; i < NB_CHANNELS_USED; i++) {
+				feature_proc->mean[i] = feature_proc->baseline->mean[i];
+				feature_proc->std_dev[i] = feature_proc->baseline->std_dev[i];
 			}
+			feature_proc->warm_started = 1;
+			start_reference(feature_proc);
+			printf("Profile of player %u verified with %u samples\n", feature_proc->baseline->id,
+			       train_stats->n);
+			printf("Training completed\n");
+			fflush(stdout);
+			return FEAT_PROC_DONE;
 		}
-	}
 
-	/*Show the training set on console */
-	printf("left\tright\n");
-	for (i = 0; i < feature_proc->nb_train_samples; i++) {
-		printf("[%i]:\t%lf\t%lf\n", i, training_set[i * 2], training_set[i * 2 + 1]);
+		printf("Profile of player %u disagrees, full training\n", feature_proc->baseline->id);
+		fflush(stdout);
 	}
 
-	/*extract the training set parameters: */
-	/* -compute the mean */
-	printf("Computing the mean\n");
-	stat_mean(training_set, feature_proc->mean, feature_proc->nb_train_samples, 2);
-	printf("mean[%i]:\t%lf\t%lf\n", i, feature_proc->mean[0], feature_proc->mean[1]);
+	if (train_stats->n < (unsigned int)feature_proc->nb_train_samples
+	    && !training_converged(feature_proc)) {
+		return FEAT_PROC_MORE;
+	}
 
-	/* -compute the standard deviation */
-	printf("Computing the std\n");
-	stat_std(training_set, feature_proc->mean, feature_proc->std_dev, feature_proc->nb_train_samples, 2);
-	printf("std[%i]:\t%lf\t%lf\n", i, feature_proc->std_dev[0], feature_proc->std_dev[1]);
+	/*the training set parameters are those accumulated */
+	for (i = 0; i < NB_CHANNELS_USED; i++) {
+		feature_proc->mean[i] = train_stats->mean[i];
+		feature_proc->std_dev[i] = running_stats_std(train_stats, i);
+	}
+	start_reference(feature_proc);
+	printf("mean[%u]:\t%lf\t%lf\n", train_stats->n, feature_proc->mean[0], feature_proc->mean[1]);
+	printf("std[%u]:\t%lf\t%lf\n", train_stats->n, feature_proc->std_dev[0], feature_proc->std_dev[1]);
 	fflush(stdout);
 
-	printf("Training completed\n");
-	free(training_set);
+	printf("Training completed with %u samples\n", train_stats->n);
 
+	return FEAT_PROC_DONE;
+}
+
+/**
+ * int training_converged(feat_proc_t* feature_proc)
+ * @brief tells if the training statistics are precise enough to stop, that is
+ * once the minimum number of samples is in and the confidence interval of the
+ * mean of each feature is within the tolerance, relative to that mean
+ * @param feature_proc, pointer to feature processing
+ * @return 1 if converged, 0 otherwise
+ */
+static int training_converged(feat_proc_t * feature_proc)
+{
+
+	int i = 0;
+	running_stats_t *train_stats = &(feature_proc->train_stats);
+
+	if (feature_proc->train_tolerance <= 0.0
+	    || train_stats->n < (unsigned int)feature_proc->nb_min_train_samples) {
+		return 0;
+	}
+
+	for (i = 0; i < NB_CHANNELS_USED; i++) {
+		if (running_stats_mean_ci(train_stats, i, TRAIN_CONFIDENCE_Z) >
+		    feature_proc->train_tolerance * fabs(train_stats->mean[i])) {
+			return 0;
+		}
+	}
+
+	return 1;
 }
 
 /**
  * int get_normalized_sample(feat_proc_t* feature_proc)
  * 
- * @brief parse and z-score the newly acquired sample
+ * @brief acquire, parse and z-score a new sample
  * @param feature_proc, pointer to feature processing
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
 int get_normalized_sample(feat_proc_t * feature_proc)
 {
 
-	/*pointers to the feature array */
-	frame_info_t *frame_info;
-	double *feature_array;
-	double features[2];
-	char frame_valid = 0x00;
-	double mean_left = 0;
-	double mean_right = 0;
-
 	/*make sure to return a valid sample */
-	while (!frame_valid) {
-
+	do {
 		/*request and... */
 		REQUEST_FEAT_FC(feature_proc->feature_input);
 		/*wait for a sample */
 		WAIT_FEAT_FC(feature_proc->feature_input);
 
-		/*get reference on current frame info */
-		frame_info = GET_FRAME_INFO_FC(feature_proc->feature_input);
-		/*get reference on current feature array */
-		feature_array = GET_FVECT_INFO_FC(feature_proc->feature_input);
+	} while (normalize_sample_frame(feature_proc) == FEAT_PROC_MORE);
+
+	return EXIT_SUCCESS;
+}
 
-		if (!frame_info->eye_blink_detected) {
-			/*parse feature array to find peak values around 10Hz */
-			get_mean_from_channels(&mean_left, &mean_right, feature_array);
+/**
+ * int normalize_sample_frame(feat_proc_t* feature_proc)
+ * 
+ * @brief parse and z-score the frame that has just arrived on the feature input
+ * @param feature_proc, pointer to feature processing
+ * @return FEAT_PROC_DONE if the sample is set, FEAT_PROC_MORE if the frame was invalid
+ */
+int normalize_sample_frame(feat_proc_t * feature_proc)
+{
 
-			/*get the samples */
-			features[0] = (mean_left - feature_proc->mean[0]) / feature_proc->std_dev[0];
-			features[1] = (mean_right - feature_proc->mean[1]) / feature_proc->std_dev[1];
+	/*pointers to the feature array */
+	frame_info_t *frame_info;
+	double *feature_array;
+	double features[NB_CHANNELS_USED];
+	double raw[NB_CHANNELS_USED];
+
+	/*get reference on current frame info */
+	frame_info = GET_FRAME_INFO_FC(feature_proc->feature_input);
+	/*get reference on current feature array */
+	feature_array = GET_FVECT_INFO_FC(feature_proc->feature_input);
+
+	if (frame_info->eye_blink_detected) {
+		printf("Frame invalid: ");
+		printf("Eye blink detected\n");
+		return FEAT_PROC_MORE;
+	}
 
-			/*get the normalized average */
-			feature_proc->sample = (features[0] + features[1]) / 2;
+	/*parse feature array to find peak values around 10Hz */
+	get_mean_from_channels(feature_proc, &raw[0], &raw[1], feature_array);
 
-			frame_valid = 0x01;
+	/*get the samples */
+	features[0] = (raw[0] - feature_proc->mean[0]) / feature_proc->std_dev[0];
+	features[1] = (raw[1] - feature_proc->mean[1]) / feature_proc->std_dev[1];
 
-		} else {
-			printf("Frame invalid: ");
-			if (frame_info->eye_blink_detected) {
-				printf("Eye blink detected\n");
-			}
+	/*publish the normalized average, the reference follows for the next one */
+	seqlock_write_begin(&(feature_proc->sample_lock));
+	feature_proc->sample = (features[0] + features[1]) / 2;
+	feature_proc->sample_nb++;
+	if (feature_proc->adapt_half_life > 0.0) {
+		adapt_reference(feature_proc, raw, features);
+	}
+	seqlock_write_end(&(feature_proc->sample_lock));
+
+	return FEAT_PROC_DONE;
+}
+
+/**
+ * void start_reference(feat_proc_t* feature_proc)
+ * 
+ * @brief keep the reference just trained, the adapted one starts from it
+ * @param feature_proc, pointer to feature processing
+ */
+static void start_reference(feat_proc_t * feature_proc)
+{
+
+	int i = 0;
+	double var[NB_CHANNELS_USED];
+
+	for (i = 0; i < NB_CHANNELS_USED; i++) {
+		feature_proc->trained_mean[i] = feature_proc->mean[i];
+		feature_proc->trained_std_dev[i] = feature_proc->std_dev[i];
+		var[i] = feature_proc->std_dev[i] * feature_proc->std_dev[i];
+		feature_proc->drift[i] = 0.0;
+	}
+	feature_proc->max_drift = 0.0;
+	feature_proc->nb_gated = 0;
+
+	ewma_stats_init(&(feature_proc->adapt_stats), NB_CHANNELS_USED,
+			feature_proc->adapt_half_life, feature_proc->mean, var);
+}
+
+/**
+ * void adapt_reference(feat_proc_t* feature_proc, const double* raw, const double* features)
+ * 
+ * @brief move the reference toward the sample, unless the sample is so far from
+ * it that it is more likely the effort of the player than a drift
+ * @param feature_proc, pointer to feature processing
+ * @param raw, features of the sample
+ * @param features, features of the sample, z-scored against the current reference
+ */
+static void adapt_reference(feat_proc_t * feature_proc, const double *raw, const double *features)
+{
+
+	int i = 0;
+	double bound;
+	ewma_stats_t *adapt_stats = &(feature_proc->adapt_stats);
+
+	for (i = 0; i < NB_CHANNELS_USED; i++) {
+		if (fabs(features[i]) > feature_proc->adapt_gate) {
+			feature_proc->nb_gated++;
+			return;
 		}
 	}
 
-	return EXIT_SUCCESS;
+	ewma_stats_add(adapt_stats, raw);
+
+	/*the reference never strays far from the one trained */
+	for (i = 0; i < NB_CHANNELS_USED; i++) {
+		bound = feature_proc->adapt_max_drift * feature_proc->trained_std_dev[i];
+		feature_proc->mean[i] = fmin(fmax(adapt_stats->mean[i], feature_proc->trained_mean[i] - bound),
+					     feature_proc->trained_mean[i] + bound);
+
+		feature_proc->std_dev[i] = fmin(fmax(sqrt(adapt_stats->var[i]),
+						     feature_proc->trained_std_dev[i] / ADAPT_STD_RATIO),
+						feature_proc->trained_std_dev[i] * ADAPT_STD_RATIO);
+
+		feature_proc->drift[i] = (feature_proc->mean[i] - feature_proc->trained_mean[i]) /
+		    feature_proc->trained_std_dev[i];
+		feature_proc->max_drift = fmax(feature_proc->max_drift, fabs(feature_proc->drift[i]));
+	}
 }
 
 /**
- * void get_peak_from_channels(double* max_left, double* max_right, double* feature_array)
+ * unsigned int get_published_sample(feat_proc_t* feature_proc, double* sample)
+ * 
+ * @brief non-blocking read of the last published sample, consistent even if
+ * it is being published by another thread
+ * @param feature_proc, pointer to feature processing
+ * @param sample(out), last sample value
+ * @return sequence number of the sample, 0 if none has been published yet
+ */
+unsigned int get_published_sample(feat_proc_t * feature_proc, double *sample)
+{
+
+	uint32_t seq;
+	unsigned int sample_nb;
+
+	do {
+		seq = seqlock_read_begin(&(feature_proc->sample_lock));
+		*sample = feature_proc->sample;
+		sample_nb = feature_proc->sample_nb;
+	} while (seqlock_read_retry(&(feature_proc->sample_lock), seq));
+
+	return sample_nb;
+}
+
+/**
+ * unsigned int get_training_progress(feat_proc_t* feature_proc, running_stats_t* stats)
+ * 
+ * @brief non-blocking read of the training statistics so far, consistent even
+ * if the training runs in another thread
+ * @param feature_proc, pointer to feature processing
+ * @param stats(out), mean and variance of the valid samples acquired, can be NULL
+ * @return number of valid samples acquired, out of nb_train_samples
+ */
+unsigned int get_training_progress(feat_proc_t * feature_proc, running_stats_t * stats)
+{
+
+	uint32_t seq;
+	unsigned int nb_acquired;
+
+	do {
+		seq = seqlock_read_begin(&(feature_proc->train_lock));
+		nb_acquired = feature_proc->train_stats.n;
+		if (stats != NULL) {
+			*stats = feature_proc->train_stats;
+		}
+	} while (seqlock_read_retry(&(feature_proc->train_lock), seq));
+
+	return nb_acquired;
+}
+
+/**
+ * unsigned int get_reference_drift(feat_proc_t* feature_proc, double* drift, double* max_drift, unsigned int* nb_gated)
+ * 
+ * @brief non-blocking read of how far the reference has moved since the training,
+ * consistent even if the samples are normalized in another thread
+ * @param feature_proc, pointer to feature processing
+ * @param drift(out), current shift of each feature, in trained standard deviations
+ * @param max_drift(out), largest shift so far
+ * @param nb_gated(out), samples that did not move the reference
+ * @return number of samples normalized
+ */
+unsigned int get_reference_drift(feat_proc_t * feature_proc, double *drift, double *max_drift,
+				 unsigned int *nb_gated)
+{
+
+	uint32_t seq;
+	unsigned int sample_nb;
+	int i = 0;
+
+	do {
+		seq = seqlock_read_begin(&(feature_proc->sample_lock));
+		for (i = 0; i < NB_CHANNELS_USED; i++) {
+			drift[i] = feature_proc->drift[i];
+		}
+		*max_drift = feature_proc->max_drift;
+		*nb_gated = feature_proc->nb_gated;
+		sample_nb = feature_proc->sample_nb;
+	} while (seqlock_read_retry(&(feature_proc->sample_lock), seq));
+
+	return sample_nb;
+}
+
+/**
+ * void get_peak_from_channels(feat_proc_t* feature_proc, double* max_left, double* max_right, double* feature_array)
  * @brief parse newly acquired sample to return the peak value within the defined range
+ * @param feature_proc, pointer to feature processing
  * @param max_left(out), peak value left channel
  * @param max_right(out), peak value right channel
  * @param feature_array, array of features to be parsed
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-void get_peak_from_channels(double *max_left, double *max_right, double *feature_array)
+void get_peak_from_channels(feat_proc_t * feature_proc, double *max_left, double *max_right,
+			    double *feature_array)
 {
 
 	int k = 0;
+	const band_gather_t *left = &(feature_proc->band[0]);
+	const band_gather_t *right = &(feature_proc->band[1]);
 
 	/*read beginning of feature range */
-	*max_left = feature_array[FEAT_IDX_START];
-	*max_right = feature_array[FEAT_IDX_START + SECOND_CHANNEL_OFFSET];
+	*max_left = feature_array[left->index[0]];
+	*max_right = feature_array[right->index[0]];
 
 	/*find max within the range for left and right */
-	for (k = FEAT_IDX_SECOND; k < FEAT_IDX_END; k++) {
-		if (feature_array[k] > *max_left) {
-			*max_left = feature_array[k];
+	for (k = 1; k < left->nb_bins; k++) {
+		if (feature_array[left->index[k]] > *max_left) {
+			*max_left = feature_array[left->index[k]];
 		}
 
-		if (feature_array[k + SECOND_CHANNEL_OFFSET] > *max_right) {
-			*max_right = feature_array[k + SECOND_CHANNEL_OFFSET];
+		if (feature_array[right->index[k]] > *max_right) {
+			*max_right = feature_array[right->index[k]];
 		}
 	}
 }
@@ -222,26 +471,30 @@ void get_peak_from_channels(double *max_left, double *max_right, double *feature
 
 
 /**
- * void get_mean_from_channels(double *mean_left, double *mean_right, double *feature_array)
+ * void get_mean_from_channels(feat_proc_t* feature_proc, double *mean_left, double *mean_right, double *feature_array)
  * @brief parse newly acquired sample to return the mean value within the defined range
+ * @param feature_proc, pointer to feature processing
  * @param mean_left(out), mean value left channel
  * @param mean_right(out), mean value right channel
  * @param feature_array, array of features to be parsed
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-void get_mean_from_channels(double *mean_left, double *mean_right, double *feature_array)
+void get_mean_from_channels(feat_proc_t * feature_proc, double *mean_left, double *mean_right,
+			    double *feature_array)
 {
 
 	int k = 0;
+	const band_gather_t *left = &(feature_proc->band[0]);
+	const band_gather_t *right = &(feature_proc->band[1]);
 
 	/*read beginning of feature range */
-	*mean_left = feature_array[FEAT_IDX_START];
-	*mean_right = feature_array[FEAT_IDX_START + SECOND_CHANNEL_OFFSET];
+	*mean_left = feature_array[left->index[0]];
+	*mean_right = feature_array[right->index[0]];
 
-	/*find max within the range for left and right */
-	for (k = FEAT_IDX_SECOND; k < FEAT_IDX_END; k++) {
-		*mean_left += feature_array[k];
-		*mean_right += feature_array[k + SECOND_CHANNEL_OFFSET];
+	/*gather the rest of the range for left and right */
+	for (k = 1; k < left->nb_bins; k++) {
+		*mean_left += feature_array[left->index[k]];
+		*mean_right += feature_array[right->index[k]];
 	}
 }
 
@@ -252,9 +505,12 @@ void get_mean_from_channels(double *mean_left, double *mean_right, double *featu
  * @param feature_proc, pointer to feature processing
  * @return EXIT_SUCCESS, EXIT_FAILURE
  */
-int clean_up_feat_processing(feat_proc_t * feature_proc __attribute__ ((unused)))
+int clean_up_feat_processing(feat_proc_t * feature_proc)
 {
 
+	/*nothing is allocated, the statistics live in the feature processing*/
+	(void)feature_proc;
+
 	return EXIT_SUCCESS;
 }
 
@@ -2,45 +2,107 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
 #include <wiringPi.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
 
 #include "gpio_wrapper.h"
 
 
 #define	START_DEMO 0
+#define START_DEMO_POLL_MS 50 /*without interrupts*/
 
+static void start_demo_isr(void);
+
+/*posted on each edge of the start button, and to cancel the wait*/
+static sem_t start_demo_event;
+static char start_demo_interrupts = 0x00;
+static volatile sig_atomic_t start_demo_cancelled = 0;
 
-void setup_gpios(void){
 
+void setup_gpios(void){
+	  
 	  /*setup the wiring pi*/
 	  if (wiringPiSetup () == -1)
 			exit (1) ;
 	  
 	  /*define the pins functions*/
 	  pinMode(START_DEMO, INPUT);
-	
-	
+	  
+	  /*the start button wakes up the waiting thread, instead of being polled*/
+	  sem_init(&start_demo_event, 0, 0);
+	  if (wiringPiISR(START_DEMO, INT_EDGE_BOTH, &start_demo_isr) < 0){
+			fprintf(stderr, "Start button: no interrupt, polled every %i ms\n", START_DEMO_POLL_MS);
+	  }else{
+			start_demo_interrupts = 0x01;
+	  }
+	  
+}
+
+
+/**
+ * void start_demo_isr(void)
+ * @brief called by wiringPi on each edge of the start button
+ */
+static void start_demo_isr(void)
+{
+	  sem_post(&start_demo_event);
 }
 
 
 /**
- * void wait_for_coin_insertion(void)
- * @brief blocking call that waits for coin insertion
+ * void wait_start_demo_edge(void)
+ * @brief sleep until the start button might have changed
  */
-void wait_for_start_demo(void)
+static void wait_start_demo_edge(void)
 {
-	  printf("Waiting to start\n"); 
+	  if (!start_demo_interrupts){
+			delay(START_DEMO_POLL_MS);
+			return;
+	  }
+	  
+	  /*edges since the last read are counted, so none is missed*/
+	  while (sem_wait(&start_demo_event) != 0 && errno == EINTR);
+}
+
+
+/**
+ * char wait_for_start_demo(void)
+ * @brief blocking call that waits for the start button to be pressed and released,
+ *        the process sleeps until the button changes
+ * @return 0x01 if started, 0x00 if cancelled
+ */
+char wait_for_start_demo(void)
+{
+	  printf("Waiting to start\n");
 	  fflush(stdout);
 	  
 	  /*wait for start button to be pressed*/
-	  while (digitalRead(START_DEMO)==HIGH)
-		delay(50);
-		
+	  while (digitalRead(START_DEMO)==HIGH && !start_demo_cancelled)
+		wait_start_demo_edge();
+	  
 	  /*wait for start button to be released*/
-	  while (digitalRead(START_DEMO)==LOW)
-		delay(50);
+	  while (digitalRead(START_DEMO)==LOW && !start_demo_cancelled)
+		wait_start_demo_edge();
+	  
+	  if (start_demo_cancelled)
+		return 0x00;
 	  
 	  /*inform user*/
 	  printf("Starting!\n");
+	  return 0x01;
+}
+
+
+/**
+ * void cancel_wait_for_start_demo(void)
+ * @brief wake up wait_for_start_demo for good, safe from a signal handler
+ */
+void cancel_wait_for_start_demo(void)
+{
+	  start_demo_cancelled = 1;
+	  if (start_demo_interrupts)
+		sem_post(&start_demo_event);
 }
@@ -0,0 +1,203 @@
+/**
+ * @file led_encoder.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Wire formats of the LED chipsets. The raw format sends the RGB
+ * triples as rendered, APA102 wraps them in start, pixel and end frames and
+ * WS2812 is bit expanded to be clocked out of a SPI bus. The tables are
+ * built when the encoder is initialized, the frame loop only loads from them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "led_encoder.h"
+#include "xml.h"
+
+static size_t encode_raw(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire);
+static size_t encode_apa102(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire);
+static size_t encode_ws2812(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire);
+static size_t apa102_end_size(int nb_leds);
+
+/**
+ * int init_led_encoder(char encoding, double gamma, double brightness, led_encoder_t* encoder)
+ * @brief build the tables of the encoder
+ * @param encoding, wire format (RAW_LED_ENCODING, APA102_LED_ENCODING, WS2812_LED_ENCODING)
+ * @param gamma, exponent of the correction, 1.0 for none
+ * @param brightness, scale of the levels, between 0 and 1
+ * @param encoder, encoder to initialize
+ * @return EXIT_FAILURE for unknown encoding, EXIT_SUCCESS for known/success
+ */
+int init_led_encoder(char encoding, double gamma, double brightness, led_encoder_t* encoder){
+	
+	double scale;
+	int level;
+	int value;
+	int bit;
+	uint32_t code;
+	
+	if(gamma <= 0.0){
+		fprintf(stderr, "LED encoder: invalid gamma %f\n", gamma);
+		return EXIT_FAILURE;
+	}
+	brightness = brightness<0.0?0.0:(brightness>1.0?1.0:brightness);
+	scale = brightness;
+	
+	if(encoding == RAW_LED_ENCODING){
+		encoder->name = "RAW";
+		encoder->encode = &encode_raw;
+	}
+	else if(encoding == APA102_LED_ENCODING){
+		encoder->name = "APA102";
+		encoder->encode = &encode_apa102;
+		
+		/*the brightness goes to the global field first, to keep the resolution of the levels*/
+		encoder->global = (uint8_t)ceil(APA102_MAX_BRIGHTNESS*brightness);
+		if(encoder->global > 0){
+			scale = brightness*APA102_MAX_BRIGHTNESS/encoder->global;
+		}
+		encoder->global |= APA102_BRIGHTNESS_MARK;
+	}
+	else if(encoding == WS2812_LED_ENCODING){
+		encoder->name = "WS2812";
+		encoder->encode = &encode_ws2812;
+	}
+	else{
+		fprintf(stderr, "Unknown LED encoding\n");
+		return EXIT_FAILURE;
+	}
+	
+	for(value=0;value<256;value++){
+		
+		level = (int)lround(255.0*scale*pow(value/255.0, gamma));
+		encoder->level[value] = level>255?255:level;
+		
+		/*each bit of the level, most significant first, on 3 bits of the wire*/
+		code = 0;
+		for(bit=7;bit>=0;bit--){
+			code = (code<<WS2812_BITS_PER_BIT) | ((encoder->level[value]>>bit)&0x01?0x06:0x04);
+		}
+		encoder->code[value][0] = (code>>16)&0xFF;
+		encoder->code[value][1] = (code>>8)&0xFF;
+		encoder->code[value][2] = code&0xFF;
+	}
+	
+	printf("LED encoder: %s, gamma %.2f, brightness %.2f\n", encoder->name, gamma, brightness);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * size_t led_encoder_size(const led_encoder_t* encoder, int nb_leds)
+ * @brief size of a frame on the wire
+ * @param encoder, reference to the encoder
+ * @param nb_leds, number of LEDs of the frame
+ * @return size, in bytes
+ */
+size_t led_encoder_size(const led_encoder_t* encoder, int nb_leds){
+	
+	if(encoder->encode == &encode_apa102){
+		return APA102_START_SIZE+nb_leds*APA102_PIXEL_SIZE+apa102_end_size(nb_leds);
+	}
+	else if(encoder->encode == &encode_ws2812){
+		return nb_leds*sizeof(pixel_t)*WS2812_CODE_SIZE+WS2812_RESET_SIZE;
+	}
+	
+	return nb_leds*sizeof(pixel_t);
+}
+
+/**
+ * size_t apa102_end_size(int nb_leds)
+ * @brief size of the end frame of APA102, the data is delayed by half a clock
+ *        per LED, so it takes one more clock every two LEDs to reach the last one
+ * @param nb_leds, number of LEDs of the frame
+ * @return size, in bytes
+ */
+static size_t apa102_end_size(int nb_leds){
+	
+	size_t size = (nb_leds+15)/16;
+	
+	return size<4?4:size;
+}
+
+/**
+ * size_t encode_raw(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire)
+ * @brief corrected RGB triples
+ * @param param, reference to the encoder
+ * @param frame, frame rendered
+ * @param nb_leds, number of LEDs to encode
+ * @param (out)wire, encoded frame
+ * @return size of the encoded frame
+ */
+static size_t encode_raw(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire){
+	
+	const led_encoder_t* encoder = (const led_encoder_t*)param;
+	int i;
+	
+	for(i=0;i<nb_leds;i++){
+		wire[0] = encoder->level[frame[i].red];
+		wire[1] = encoder->level[frame[i].green];
+		wire[2] = encoder->level[frame[i].blue];
+		wire += sizeof(pixel_t);
+	}
+	
+	return nb_leds*sizeof(pixel_t);
+}
+
+/**
+ * size_t encode_apa102(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire)
+ * @brief start frame, brightness and corrected BGR of each LED, end frame
+ * @param param, reference to the encoder
+ * @param frame, frame rendered
+ * @param nb_leds, number of LEDs to encode
+ * @param (out)wire, encoded frame
+ * @return size of the encoded frame
+ */
+static size_t encode_apa102(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire){
+	
+	const led_encoder_t* encoder = (const led_encoder_t*)param;
+	size_t end_size = apa102_end_size(nb_leds);
+	int i;
+	
+	memset(wire, 0x00, APA102_START_SIZE);
+	wire += APA102_START_SIZE;
+	
+	for(i=0;i<nb_leds;i++){
+		wire[0] = encoder->global;
+		wire[1] = encoder->level[frame[i].blue];
+		wire[2] = encoder->level[frame[i].green];
+		wire[3] = encoder->level[frame[i].red];
+		wire += APA102_PIXEL_SIZE;
+	}
+	
+	/*zeros, such that the clocks don't light one more LED*/
+	memset(wire, 0x00, end_size);
+	
+	return APA102_START_SIZE+nb_leds*APA102_PIXEL_SIZE+end_size;
+}
+
+/**
+ * size_t encode_ws2812(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire)
+ * @brief expanded GRB of each LED, then the reset
+ * @param param, reference to the encoder
+ * @param frame, frame rendered
+ * @param nb_leds, number of LEDs to encode
+ * @param (out)wire, encoded frame
+ * @return size of the encoded frame
+ */
+static size_t encode_ws2812(const void* param, const pixel_t* frame, int nb_leds, uint8_t* wire){
+	
+	const led_encoder_t* encoder = (const led_encoder_t*)param;
+	int i;
+	
+	for(i=0;i<nb_leds;i++){
+		memcpy(&(wire[0]), encoder->code[frame[i].green], WS2812_CODE_SIZE);
+		memcpy(&(wire[WS2812_CODE_SIZE]), encoder->code[frame[i].red], WS2812_CODE_SIZE);
+		memcpy(&(wire[2*WS2812_CODE_SIZE]), encoder->code[frame[i].blue], WS2812_CODE_SIZE);
+		wire += sizeof(pixel_t)*WS2812_CODE_SIZE;
+	}
+	
+	memset(wire, 0x00, WS2812_RESET_SIZE);
+	
+	return nb_leds*sizeof(pixel_t)*WS2812_CODE_SIZE+WS2812_RESET_SIZE;
+}
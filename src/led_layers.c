@@ -0,0 +1,126 @@
+/**
+ * @file led_layers.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Layers of the LED strip, composited with saturating adds. Animations
+ * are painted in their own layer instead of over each other in the frame, and
+ * the adds run on 16 bytes at a time with NEON or SSE2 when available.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LAYERS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LAYERS_SSE2 1
+#endif
+
+#include "led_layers.h"
+
+/**
+ * void layer_init(led_layer_t* layer)
+ * @brief initialize a black layer
+ * @param layer, reference to the layer
+ */
+void layer_init(led_layer_t* layer){
+	
+	memset(layer->pixels, 0, sizeof(layer->pixels));
+	layer->first = 0;
+	layer->last = -1;
+}
+
+/**
+ * pixel_t* layer_begin(led_layer_t* layer, int first, int last)
+ * @brief clear the layer and set the range to be painted
+ * @param layer, reference to the layer
+ * @param first, first LED to be painted
+ * @param last, last LED to be painted (included)
+ * @return pixels of the layer, only first to last may be painted
+ */
+pixel_t* layer_begin(led_layer_t* layer, int first, int last){
+	
+	layer_clear(layer);
+	
+	layer->first = first<0?0:first;
+	layer->last = last>=MAX_NB_LEDS?MAX_NB_LEDS-1:last;
+	
+	return layer->pixels;
+}
+
+/**
+ * void layer_clear(led_layer_t* layer)
+ * @brief turn the range painted back to black
+ * @param layer, reference to the layer
+ */
+void layer_clear(led_layer_t* layer){
+	
+	if(layer->first <= layer->last){
+		memset(&(layer->pixels[layer->first]), 0, (layer->last-layer->first+1)*sizeof(pixel_t));
+	}
+	
+	layer->first = 0;
+	layer->last = -1;
+}
+
+/**
+ * void layers_composite(const led_layer_t* layers, int nb_layers, pixel_t* frame, int nb_leds)
+ * @brief add the layers into the frame, in order
+ * @param layers, layers to add
+ * @param nb_layers, number of layers
+ * @param (out)frame, frame of the strip
+ * @param nb_leds, length of the strip
+ */
+void layers_composite(const led_layer_t* layers, int nb_layers, pixel_t* frame, int nb_leds){
+	
+	int i;
+	int last;
+	
+	memset(frame, 0, nb_leds*sizeof(pixel_t));
+	
+	for(i=0;i<nb_layers;i++){
+		
+		last = layers[i].last<nb_leds?layers[i].last:nb_leds-1;
+		
+		if(layers[i].first <= last){
+			pixels_add_saturate(&(frame[layers[i].first]), &(layers[i].pixels[layers[i].first]),
+								last-layers[i].first+1);
+		}
+	}
+}
+
+/**
+ * void pixels_add_saturate(pixel_t* dest, const pixel_t* src, int nb_pixels)
+ * @brief add the pixels to the destination, each channel saturates at 255
+ * @param dest, pixels added to
+ * @param src, pixels to add
+ * @param nb_pixels, number of pixels
+ */
+void pixels_add_saturate(pixel_t* dest, const pixel_t* src, int nb_pixels){
+	
+	uint8_t* d = (uint8_t*)dest;
+	const uint8_t* s = (const uint8_t*)src;
+	int nb_bytes = nb_pixels*sizeof(pixel_t);
+	int sum;
+	int i = 0;
+	
+	/*the channels don't matter, the pixels are added as a byte buffer*/
+#if defined(LAYERS_NEON)
+	for(;i+16<=nb_bytes;i+=16){
+		vst1q_u8(&(d[i]), vqaddq_u8(vld1q_u8(&(d[i])), vld1q_u8(&(s[i]))));
+	}
+#elif defined(LAYERS_SSE2)
+	for(;i+16<=nb_bytes;i+=16){
+		_mm_storeu_si128((__m128i*)&(d[i]), _mm_adds_epu8(_mm_loadu_si128((const __m128i*)&(d[i])),
+														  _mm_loadu_si128((const __m128i*)&(s[i]))));
+	}
+#endif
+
+	/*the rest, or all of it without SIMD*/
+	for(;i<nb_bytes;i++){
+		sum = d[i]+s[i];
+		d[i] = sum>255?255:sum;
+	}
+}
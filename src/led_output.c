@@ -0,0 +1,71 @@
+/**
+ * @file led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Sets the virtual interface the LED frames are sent to.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_output.h"
+#include "spi_led_output.h"
+#include "null_led_output.h"
+#include "memory_led_output.h"
+#include "file_led_output.h"
+#include "udp_led_output.h"
+#include "xml.h"
+
+/**
+ * int init_led_output(char output_type, const char* target, long keep_alive_ns, led_output_t* led_output)
+ * 
+ * @brief Select the backend operations for the LED output based on the type
+ * of sink which could be the spidev driver (SPI), nothing (NULL), a ring of 
+ * frames in memory (MEMORY), a mapped frame log (FILE) or a networked pixel
+ * controller (UDP). The output is opened by the LED writer.
+ * @param output_type, identifier of the type of output
+ * @param target, device, file or host:port of the output
+ * @param keep_alive_ns, longest time without a transfer, while the frames don't
+ *        change. 0 to send every frame
+ * @param led_output, LED output to initialize
+ * @return EXIT_FAILURE for unknown type, EXIT_SUCCESS for known/success
+ */
+int init_led_output(char output_type, const char* target, long keep_alive_ns, led_output_t* led_output){
+	
+	/*default values*/
+	led_output->ops = NULL;
+	led_output->fd = -1;
+	led_output->buf = NULL;
+	led_output->buf_size = 0;
+	led_output->nb_frames = 0;
+	led_output->keep_alive_ns = keep_alive_ns;
+	
+	if(strlen(target) >= LED_OUTPUT_TARGET_LENGTH){
+		fprintf(stderr, "LED output target too long: %s\n", target);
+		return EXIT_FAILURE;
+	}
+	strcpy(led_output->target, target);
+	
+	if(output_type == SPI_LED_OUTPUT){
+		led_output->ops = &spi_led_output_ops;
+	}
+	else if(output_type == NULL_LED_OUTPUT){
+		led_output->ops = &null_led_output_ops;
+	}
+	else if(output_type == MEMORY_LED_OUTPUT){
+		led_output->ops = &memory_led_output_ops;
+	}
+	else if(output_type == FILE_LED_OUTPUT){
+		led_output->ops = &file_led_output_ops;
+	}
+	else if(output_type == UDP_LED_OUTPUT){
+		led_output->ops = &udp_led_output_ops;
+	}
+	else{
+		fprintf(stderr, "Unknown LED output type\n");
+		return EXIT_FAILURE;
+	}
+	
+	printf("LED output: %s %s\n", led_output->ops->name, led_output->target);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file led_strip.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Scrolling segments of the LED strip. Particles move along the strip 
+ * by rotating a ring, instead of copying every pixel of the strip, and the
+ * segments are linearized into the frame once per frame.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led_strip.h"
+
+/**
+ * void segment_init(strip_segment_t* segment, int direction, int length)
+ * @brief initialize a segment with black pixels
+ * @param segment, reference to the segment
+ * @param direction, SEGMENT_ASCENDING if pixels move toward the end of the strip,
+ *        SEGMENT_DESCENDING if they move toward the beginning
+ * @param length, number of LEDs of the strip, at most MAX_NB_LEDS
+ */
+void segment_init(strip_segment_t* segment, int direction, int length){
+	
+	memset(segment->ring, 0, length*sizeof(pixel_t));
+	segment->length = length;
+	segment->head = 0;
+	segment->direction = direction;
+}
+
+/**
+ * void segment_push(strip_segment_t* segment, const pixel_t* pixel)
+ * @brief push a new pixel at the entry of the segment, moving all the others by one LED
+ * @param segment, reference to the segment
+ * @param pixel, new pixel
+ */
+void segment_push(strip_segment_t* segment, const pixel_t* pixel){
+	
+	/*the ring is in strip order, so it rotates against the direction*/
+	segment->head -= segment->direction;
+	
+	if(segment->head < 0){
+		segment->head += segment->length;
+	}else if(segment->head >= segment->length){
+		segment->head -= segment->length;
+	}
+	
+	segment->ring[segment->head] = *pixel;
+}
+
+/**
+ * void segment_render(const strip_segment_t* segment, pixel_t* frame, int entry, int first, int last)
+ * @brief copy the segment in the frame, for the LEDs first to last. The LED entry shows the 
+ *        newest pixel, the LED at distance d from it shows the pixel pushed d times ago.
+ * @param segment, reference to the segment
+ * @param frame, frame of the length of the segment
+ * @param entry, LED at the entry of the segment
+ * @param first, first LED to copy
+ * @param last, last LED to copy (included)
+ */
+void segment_render(const strip_segment_t* segment, pixel_t* frame, int entry, int first, int last){
+	
+	int start;
+	int count;
+	int block;
+	
+	/*keep within the strip*/
+	if(first < 0){
+		first = 0;
+	}
+	if(last >= segment->length){
+		last = segment->length-1;
+	}
+	if(first > last){
+		return;
+	}
+	
+	/*ring index of the first LED, in either direction the ring follows the strip*/
+	start = (segment->head + first - entry) % segment->length;
+	if(start < 0){
+		start += segment->length;
+	}
+	count = last-first+1;
+	
+	/*copy up to the end of the ring, then the rest from its beginning*/
+	block = segment->length-start;
+	if(block > count){
+		block = count;
+	}
+	memcpy(&(frame[first]), &(segment->ring[start]), block*sizeof(pixel_t));
+	
+	if(block < count){
+		memcpy(&(frame[first+block]), &(segment->ring[0]), (count-block)*sizeof(pixel_t));
+	}
+}
+
+/**
+ * int frame_dirty_range(const pixel_t* previous, const pixel_t* frame, int nb_leds, int* first, int* last)
+ * @brief find the range of LEDs that changed between two frames
+ * @param previous, frame previously sent
+ * @param frame, new frame
+ * @param nb_leds, number of LEDs in the frames
+ * @param (out)first, first LED that changed
+ * @param (out)last, last LED that changed
+ * @return 1 if the frame changed, 0 otherwise (first and last are left untouched)
+ */
+int frame_dirty_range(const pixel_t* previous, const pixel_t* frame, int nb_leds, int* first, int* last){
+	
+	int low = 0;
+	int high = nb_leds-1;
+	
+	while(low<nb_leds && memcmp(&(previous[low]), &(frame[low]), sizeof(pixel_t)) == 0){
+		low++;
+	}
+	
+	if(low == nb_leds){
+		return 0;
+	}
+	
+	while(memcmp(&(previous[high]), &(frame[high]), sizeof(pixel_t)) == 0){
+		high--;
+	}
+	
+	*first = low;
+	*last = high;
+	return 1;
+}
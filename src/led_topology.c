@@ -0,0 +1,202 @@
+/**
+ * @file led_topology.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Layout of the LED strip over several segments and buses. The strip
+ * rendered by the game is split into the frames of the buses, each sent by
+ * its own writer thread, so a longer strip is spread over parallel transfers
+ * instead of a single longer one.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "led_topology.h"
+
+/**
+ * int led_topology_add_bus(led_topology_t* topology, char output_type, const char* target, uint32_t speed_hz,
+ *                          char encoding, double gamma, double brightness, long keep_alive_ns)
+ * @brief add a bus, it is opened when the topology is started
+ * @param topology, reference to the topology
+ * @param output_type, type of LED output (SPI_LED_OUTPUT, NULL_LED_OUTPUT, ...)
+ * @param target, device, file or host:port of the output
+ * @param speed_hz, SPI clock
+ * @param encoding, wire format of the LEDs (RAW_LED_ENCODING, APA102_LED_ENCODING, WS2812_LED_ENCODING)
+ * @param gamma, exponent of the color correction, 1.0 for none
+ * @param brightness, scale of the levels, between 0 and 1
+ * @param keep_alive_ns, longest time without a transfer, 0 to send every frame
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int led_topology_add_bus(led_topology_t* topology, char output_type, const char* target, uint32_t speed_hz,
+						 char encoding, double gamma, double brightness, long keep_alive_ns){
+	
+	led_bus_t* bus;
+	
+	if(topology->nb_buses >= MAX_LED_BUSES){
+		fprintf(stderr, "LED topology: more than %d buses\n", MAX_LED_BUSES);
+		return EXIT_FAILURE;
+	}
+	bus = &(topology->bus[topology->nb_buses]);
+	
+	/*the bit expansion of the WS2812 only has its timing at one clock*/
+	if(encoding == WS2812_LED_ENCODING &&
+	   fabs((double)speed_hz-WS2812_SPI_SPEED) > WS2812_SPI_SPEED*WS2812_SPI_SPEED_TOLERANCE){
+		fprintf(stderr, "LED topology: WS2812 needs a clock of %d Hz, not %u Hz\n", WS2812_SPI_SPEED, speed_hz);
+		return EXIT_FAILURE;
+	}
+	
+	bus->led_output.speed_hz = speed_hz;
+	if(init_led_output(output_type, target, keep_alive_ns, &(bus->led_output)) == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	bus->nb_leds = 0;
+	
+	if(init_led_encoder(encoding, gamma, brightness, &(bus->led_encoder)) == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	
+	topology->nb_buses++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int led_topology_add_segment(led_topology_t* topology, int bus, int length, char reversed)
+ * @brief add a segment at the end of the strip, it follows the previous segments of its bus
+ * @param topology, reference to the topology
+ * @param bus, index of the bus it is wired to
+ * @param length, number of LEDs
+ * @param reversed, 1 if wired from its last LED, 0 otherwise
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int led_topology_add_segment(led_topology_t* topology, int bus, int length, char reversed){
+	
+	led_segment_map_t* segment;
+	
+	if(topology->nb_segments >= MAX_LED_SEGMENTS){
+		fprintf(stderr, "LED topology: more than %d segments\n", MAX_LED_SEGMENTS);
+		return EXIT_FAILURE;
+	}
+	if(bus < 0 || bus >= topology->nb_buses){
+		fprintf(stderr, "LED topology: no bus %d\n", bus);
+		return EXIT_FAILURE;
+	}
+	if(length <= 0 || topology->nb_leds+length > MAX_NB_LEDS){
+		fprintf(stderr, "LED topology: segment of %d LEDs, the strip is limited to %d\n", length, MAX_NB_LEDS);
+		return EXIT_FAILURE;
+	}
+	segment = &(topology->segment[topology->nb_segments]);
+	
+	segment->start = topology->nb_leds;
+	segment->length = length;
+	segment->bus = bus;
+	segment->offset = topology->bus[bus].nb_leds;
+	segment->reversed = reversed;
+	
+	topology->bus[bus].nb_leds += length;
+	topology->nb_leds += length;
+	topology->nb_segments++;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int start_led_topology(led_topology_t* topology, double rate_hz)
+ * @brief open the output of each bus and start its writer
+ * @param topology, reference to the topology
+ * @param rate_hz, frame rate
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int start_led_topology(led_topology_t* topology, double rate_hz){
+	
+	int i;
+	
+	for(i=0;i<topology->nb_buses;i++){
+		
+		if(topology->bus[i].nb_leds == 0){
+			fprintf(stderr, "LED topology: bus %d has no segment\n", i);
+		}
+		else if(start_led_writer(&(topology->bus[i].writer), &(topology->bus[i].led_output), &(topology->bus[i].led_encoder),
+								 topology->bus[i].nb_leds, rate_hz) == EXIT_SUCCESS){
+			continue;
+		}
+		
+		/*stop the buses already started*/
+		while(--i >= 0){
+			stop_led_writer(&(topology->bus[i].writer));
+		}
+		return EXIT_FAILURE;
+	}
+	
+	printf("LED topology: %d LEDs, %d segments, %d buses\n", topology->nb_leds,
+		   topology->nb_segments, topology->nb_buses);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void led_topology_present(led_topology_t* topology, const pixel_t* strip)
+ * @brief split the strip into the back buffers of the buses and publish them. Never blocks.
+ * @param topology, reference to the topology
+ * @param strip, frame of nb_leds pixels, in the order of the strip
+ */
+void led_topology_present(led_topology_t* topology, const pixel_t* strip){
+	
+	led_segment_map_t* segment;
+	pixel_t* frame;
+	int i;
+	int j;
+	
+	for(i=0;i<topology->nb_segments;i++){
+		
+		segment = &(topology->segment[i]);
+		frame = led_writer_back(&(topology->bus[segment->bus].writer))+segment->offset;
+		
+		if(segment->reversed){
+			for(j=0;j<segment->length;j++){
+				frame[j] = strip[segment->start+segment->length-1-j];
+			}
+		}else{
+			memcpy(frame, &(strip[segment->start]), segment->length*sizeof(pixel_t));
+		}
+	}
+	
+	for(i=0;i<topology->nb_buses;i++){
+		led_writer_swap(&(topology->bus[i].writer));
+	}
+}
+
+/**
+ * void led_topology_set_idle(led_topology_t* topology, char idle)
+ * @brief idle the writers of all the buses, they only wake up for the frames
+ *        published and the keep-alive
+ * @param topology, reference to the topology
+ * @param idle, 0x01 to idle, 0x00 to get back to the frame rate
+ */
+void led_topology_set_idle(led_topology_t* topology, char idle){
+	
+	int i;
+	
+	for(i=0;i<topology->nb_buses;i++){
+		led_writer_set_idle(&(topology->bus[i].writer), idle);
+	}
+}
+
+/**
+ * int stop_led_topology(led_topology_t* topology)
+ * @brief send the last frame published, stop the writer and close the output of each bus
+ * @param topology, reference to the topology
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int stop_led_topology(led_topology_t* topology){
+	
+	int i;
+	int res = EXIT_SUCCESS;
+	
+	for(i=0;i<topology->nb_buses;i++){
+		if(stop_led_writer(&(topology->bus[i].writer)) == EXIT_FAILURE){
+			res = EXIT_FAILURE;
+		}
+	}
+	
+	return res;
+}
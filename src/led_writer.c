@@ -0,0 +1,309 @@
+/**
+ * @file led_writer.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Output thread of the LED strip. Rendering and output are split, so a
+ * stall of the LED output doesn't delay the game animation, and the frames
+ * are sent at a fixed rate instead of the render time plus the transfer time.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "led_writer.h"
+
+static void* led_writer_loop(void* param);
+static int led_writer_send(led_writer_t* writer);
+
+/**
+ * int start_led_writer(led_writer_t* writer, led_output_t* led_output, const led_encoder_t* led_encoder, int nb_leds, double rate_hz)
+ * @brief allocate the frames, open the LED output and create the writer thread
+ * @param writer, reference to the writer
+ * @param led_output, initialized LED output, see init_led_output
+ * @param led_encoder, initialized encoder of the wire format, see init_led_encoder
+ * @param nb_leds, number of LEDs driven by the output
+ * @param rate_hz, frame rate
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int start_led_writer(led_writer_t* writer, led_output_t* led_output, const led_encoder_t* led_encoder, int nb_leds, double rate_hz){
+	
+	pixel_t* block;
+	int i;
+	
+	/*the frames and the copy of the strip, in a single block*/
+	block = (pixel_t*)calloc((LED_WRITER_NB_FRAMES+1)*nb_leds, sizeof(pixel_t));
+	if(block == NULL){
+		perror("LED writer");
+		return EXIT_FAILURE;
+	}
+	for(i=0;i<LED_WRITER_NB_FRAMES;i++){
+		writer->frames[i] = block+i*nb_leds;
+	}
+	writer->sent = block+LED_WRITER_NB_FRAMES*nb_leds;
+	writer->nb_leds = nb_leds;
+	writer->rate_hz = rate_hz;
+	
+	writer->wire = (uint8_t*)malloc(led_encoder_size(led_encoder, nb_leds));
+	if(writer->wire == NULL){
+		perror("LED writer");
+		free(block);
+		return EXIT_FAILURE;
+	}
+	snprintf(writer->name, LED_WRITER_NAME_LENGTH, "LED writer %s", led_output->target);
+	
+	writer->back = 0;
+	writer->latest = 1;
+	writer->front = 2;
+	
+	writer->nb_published = 0;
+	writer->nb_dropped = 0;
+	writer->nb_sent = 0;
+	writer->nb_repeated = 0;
+	writer->nb_unchanged = 0;
+	writer->total_bytes = 0.0;
+	writer->max_transfer_ns = 0;
+	writer->total_transfer_ns = 0.0;
+	
+	if(tick_scheduler_init(&(writer->sched), rate_hz) == EXIT_FAILURE){
+		free(writer->wire);
+		free(block);
+		return EXIT_FAILURE;
+	}
+	
+	/*the output gets the frames in the wire format*/
+	writer->led_output = led_output;
+	writer->led_encoder = led_encoder;
+	led_output->frame_size = led_encoder_size(led_encoder, nb_leds);
+	
+	if(OPEN_LED_OUTPUT_FC(led_output) == EXIT_FAILURE){
+		free(writer->wire);
+		free(block);
+		return EXIT_FAILURE;
+	}
+	
+	/*transfers are shifted by half a period, in between the frames rendered*/
+	timespec_add_ns(&(writer->sched.next), writer->sched.period_ns/2);
+	
+	writer->alive = 0x01;
+	writer->idle = 0x00;
+	writer->idling = 0x00;
+	writer->parked = 0;
+	
+	if(pthread_create(&(writer->thread), NULL, led_writer_loop, (void*)writer) != 0){
+		perror("LED writer");
+		CLOSE_LED_OUTPUT_FC(led_output);
+		free(writer->wire);
+		free(block);
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * pixel_t* led_writer_back(led_writer_t* writer)
+ * @brief frame to render into, owned by the renderer until swapped
+ * @param writer, reference to the writer
+ * @return frame of nb_leds pixels
+ */
+pixel_t* led_writer_back(led_writer_t* writer){
+	return writer->frames[writer->back];
+}
+
+/**
+ * void led_writer_swap(led_writer_t* writer)
+ * @brief publish the back buffer, it is sent on the next transfer. Never blocks.
+ * @param writer, reference to the writer
+ */
+void led_writer_swap(led_writer_t* writer){
+	
+	uint32_t previous;
+	
+	previous = __atomic_exchange_n(&(writer->latest), writer->back|LED_FRAME_FRESH, __ATOMIC_SEQ_CST);
+	
+	/*the writer announced it sleeps, after checking latest*/
+	if(__atomic_load_n(&(writer->parked), __ATOMIC_SEQ_CST)){
+		syscall(SYS_futex, &(writer->latest), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+	
+	/*the previous frame was never sent*/
+	if(previous & LED_FRAME_FRESH){
+		writer->nb_dropped++;
+	}
+	
+	writer->back = previous & LED_FRAME_IDX_MASK;
+	writer->nb_published++;
+}
+
+/**
+ * void led_writer_set_idle(led_writer_t* writer, char idle)
+ * @brief while idle, the writer only wakes up when a frame is published and
+ *        at LED_WRITER_IDLE_RATE, instead of the frame rate
+ * @param writer, reference to the writer
+ * @param idle, 0x01 to idle, 0x00 to get back to the frame rate
+ */
+void led_writer_set_idle(led_writer_t* writer, char idle){
+	__atomic_store_n(&(writer->idle), idle, __ATOMIC_RELEASE);
+}
+
+/**
+ * int stop_led_writer(led_writer_t* writer)
+ * @brief send the last frame published, join the writer thread, close the LED output
+ *        and free the frames
+ * @param writer, reference to the writer
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int stop_led_writer(led_writer_t* writer){
+	
+	__atomic_store_n(&(writer->alive), 0x00, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&(writer->parked), __ATOMIC_SEQ_CST)){
+		syscall(SYS_futex, &(writer->latest), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+	pthread_join(writer->thread, NULL);
+	
+	/*flush the last frame, typically to turn off the strip*/
+	if(__atomic_load_n(&(writer->latest), __ATOMIC_ACQUIRE) & LED_FRAME_FRESH){
+		led_writer_send(writer);
+	}
+	
+	CLOSE_LED_OUTPUT_FC(writer->led_output);
+	
+	/*report*/
+	printf("%s: %lu frames published, %lu dropped\n", writer->name, writer->nb_published, writer->nb_dropped);
+	printf("%s: %lu transfers, %lu repeated, %.3f ms avg, %.3f ms max\n", writer->name, writer->nb_sent,
+		   writer->nb_repeated, writer->nb_sent?writer->total_transfer_ns/writer->nb_sent/1e6:0.0,
+		   (double)writer->max_transfer_ns/1e6);
+	printf("%s: %lu unchanged frames skipped, %.1f%% of the frames sent, %.1f bytes per transfer\n",
+		   writer->name, writer->nb_unchanged, (writer->nb_sent+writer->nb_unchanged)?100.0*writer->nb_sent/(writer->nb_sent+writer->nb_unchanged):0.0,
+		   writer->nb_sent?writer->total_bytes/writer->nb_sent:0.0);
+	tick_scheduler_report(&(writer->sched), writer->name);
+	
+	/*the frames were allocated in a single block*/
+	free(writer->frames[0]);
+	free(writer->wire);
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void* led_writer_loop(void* param)
+ * @brief writer thread, sends the latest frame at a fixed rate
+ * @param param, reference to the writer
+ */
+static void* led_writer_loop(void* param){
+	
+	led_writer_t* writer = (led_writer_t*)param;
+	uint32_t expected;
+	char idle;
+	
+	while(__atomic_load_n(&(writer->alive), __ATOMIC_ACQUIRE)){
+		
+		idle = __atomic_load_n(&(writer->idle), __ATOMIC_ACQUIRE);
+		if(idle != writer->idling){
+			writer->idling = idle;
+			tick_scheduler_set_rate(&(writer->sched), idle?LED_WRITER_IDLE_RATE:writer->rate_hz);
+			
+			/*back in between the frames rendered*/
+			if(!idle){
+				timespec_add_ns(&(writer->sched.next), writer->sched.period_ns/2);
+			}
+		}
+		
+		if(writer->idling){
+			/*a fresh frame is already different from the index expected*/
+			__atomic_store_n(&(writer->parked), 1, __ATOMIC_SEQ_CST);
+			expected = __atomic_load_n(&(writer->latest), __ATOMIC_SEQ_CST) & LED_FRAME_IDX_MASK;
+			tick_scheduler_wait_on(&(writer->sched), &(writer->latest), expected);
+			__atomic_store_n(&(writer->parked), 0, __ATOMIC_RELAXED);
+		}else{
+			tick_scheduler_wait(&(writer->sched));
+		}
+		
+		if(led_writer_send(writer) == EXIT_FAILURE){
+			perror("LED output write failed");
+			fflush(stdout);
+			exit(1);
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * int led_writer_send(led_writer_t* writer)
+ * @brief take the latest frame, if there's a new one, and send the front buffer
+ *        in the wire format. A frame identical to what the strip shows is only
+ *        sent once the keep-alive interval of the output has elapsed. On outputs
+ *        that keep the LEDs past the end of the frame, the frame is cut after 
+ *        its last LED that changed.
+ * @param writer, reference to the writer
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+static int led_writer_send(led_writer_t* writer){
+	
+	led_output_t* led_output = writer->led_output;
+	pixel_t* frame;
+	struct timespec start;
+	struct timespec end;
+	long long transfer_ns;
+	uint32_t latest;
+	int first = 0;
+	int last = writer->nb_leds-1;
+	int count = writer->nb_leds;
+	size_t size;
+	int res;
+	
+	/*take the latest frame, the front buffer goes back in the exchange*/
+	if(__atomic_load_n(&(writer->latest), __ATOMIC_ACQUIRE) & LED_FRAME_FRESH){
+		latest = __atomic_exchange_n(&(writer->latest), writer->front, __ATOMIC_ACQ_REL);
+		writer->front = latest & LED_FRAME_IDX_MASK;
+	}else{
+		writer->nb_repeated++;
+	}
+	frame = writer->frames[writer->front];
+	
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	
+	/*compare with what the strip shows, the first frame is always sent*/
+	if(led_output->keep_alive_ns > 0 && writer->nb_sent > 0){
+		
+		if(!frame_dirty_range(writer->sent, frame, writer->nb_leds, &first, &last)){
+			
+			/*unchanged, skip it until the keep-alive is due*/
+			if(timespec_diff_ns(&start, &(writer->last_sent)) < led_output->keep_alive_ns){
+				writer->nb_unchanged++;
+				return EXIT_SUCCESS;
+			}
+			first = 0;
+			last = writer->nb_leds-1;
+		}
+		else if(led_output->ops->prefix_updates){
+			count = last+1;
+		}
+	}
+	
+	size = LED_ENCODE_FC(writer->led_encoder, frame, count, writer->wire);
+	res = WRITE_LED_OUTPUT_FC(led_output, writer->wire, size);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	
+	if(res == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	
+	memcpy(&(writer->sent[first]), &(frame[first]), (last-first+1)*sizeof(pixel_t));
+	writer->last_sent = end;
+	writer->total_bytes += size;
+	
+	transfer_ns = timespec_diff_ns(&end, &start);
+	writer->total_transfer_ns += transfer_ns;
+	if(transfer_ns > writer->max_transfer_ns){
+		writer->max_transfer_ns = transfer_ns;
+	}
+	writer->nb_sent++;
+	
+	return EXIT_SUCCESS;
+}
@@ -28,8 +28,15 @@
 #include "feature_processing.h"
 #include "ipc_status_comm.h"
 #include "feature_input.h"
+#include "feature_input_mux.h"
+#include "feat_proc_worker.h"
+#include "calib_profile.h"
+#include "feature_layout.h"
 #include "xml.h"
 #include "cerebwars_lib.h"
+#include "tick_scheduler.h"
+#include "prng.h"
+#include "gpio_wrapper.h"
 
 /*defines the frequency scale*/
 #define NB_STEPS 100
@@ -43,7 +50,15 @@
 #define PLAYER_1_SEM_KEY 1234
 #define PLAYER_2_SEM_KEY 8921
 
+/*random stream of the fake input of each player, after the renderer's*/
+#define INPUT_PRNG_STREAM 1
+
+/*game phases, deadlines in seconds from the start of the game*/
+#define GAME_COUNTDOWN 0
+#define GAME_PLAY 1 /*until test_duration*/
+#define GAME_FINISH 2
 #define GAME_START_DELAY 10
+#define GAME_FINISH_DELAY 5 /*winner animation*/
 
 
 /*function prototypes*/
@@ -52,9 +67,10 @@ char *which_config(int argc, char **argv);
 char task_running = 0x01;
 char program_running = 0x01;
 
-int configure_feature_input(feature_input_t* feature_input, appconfig_t* app_config);
-void* train_player(void* param);
-void* get_sample(void* param);
+int configure_feature_input(feature_input_t* feature_input, const feature_layout_t* feature_layout, appconfig_t* app_config);
+static double adjust_sample(double sample, double adjusted_sample);
+static void store_calib_profiles(calib_profiles_t* calib_profiles, feat_proc_t* feature_proc, appconfig_t* app_config);
+static void report_reference_drift(feat_proc_t* feature_proc, int player);
 
 /*default xml file path/name*/
 #define CONFIG_NAME "config/braintone_app_config.xml"
@@ -69,26 +85,33 @@ void* get_sample(void* param);
 int main(int argc, char *argv[])
 {	
 	/*freq index*/
-	char res;
-	char game_started = 0x00;
-	double cpu_time_used;
+	int i;
+	char game_phase = GAME_COUNTDOWN;
+	double elapsed_time;
+	double next_integration = 0;
+	double finish_time = 0;
 	double running_avg = 0;
+	double sample[NB_PLAYERS] = {0};
+	unsigned int sample_nb[NB_PLAYERS] = {0};
+	unsigned int last_sample_nb[NB_PLAYERS] = {0};
 	double adjusted_sample[NB_PLAYERS] = {0};
 	double integrated_diff = 0.5;
-	clock_t start, end;
+	int status = EXIT_SUCCESS;
+	tick_scheduler_t game_sched;
 	feature_input_t feature_input[NB_PLAYERS];
+	feature_layout_t feature_layout;
+	feature_input_mux_t input_mux;
+	feat_proc_worker_t feat_worker;
 	ipc_comm_t ipc_comm[NB_PLAYERS];
-	feat_proc_t feature_proc[NB_PLAYERS];
-	
-	pthread_attr_t attr;
-	pthread_t threads_array[NB_PLAYERS];
+	feat_proc_t feature_proc[NB_PLAYERS] = {{0}};
+	static calib_profiles_t calib_profiles;
 	
 	/*configuration structure*/
 	appconfig_t* app_config;
 	
 	/*Set up ctrl c signal handler*/
 	(void)signal(SIGINT, ctrl_c_handler);
-
+	
 	/*Show program banner on stdout*/
 	print_banner();
 	/*setup gpios*/
@@ -100,8 +123,65 @@ int main(int argc, char *argv[])
 	/*setup the buzzer*/
 	setup_buzzer_lib(DEFAULT_PIN);
 	
+	/*select where the LED frames are sent, each bus has its own output*/
+	for(i=0;i<app_config->nb_led_buses;i++){
+		if(add_led_bus(app_config->led_bus[i].output, app_config->led_bus[i].target, app_config->led_bus[i].speed_hz,
+					   app_config->led_bus[i].encoding, app_config->led_bus[i].gamma, app_config->led_bus[i].brightness,
+					   app_config->led_keep_alive) == EXIT_FAILURE){
+			return EXIT_FAILURE;
+		}
+	}
+	
+	/*the strip is laid out over the buses*/
+	for(i=0;i<app_config->nb_led_segments;i++){
+		if(add_led_segment(app_config->led_segment[i].bus, app_config->led_segment[i].length,
+						   app_config->led_segment[i].reversed) == EXIT_FAILURE){
+			return EXIT_FAILURE;
+		}
+	}
+	
+	/*each random generator is seeded from the seed of the run, it is 
+	  reported such that the run can be reproduced*/
+	if(app_config->seed == 0){
+		app_config->seed = prng_entropy_seed();
+	}
+	printf("Random seed: %llu\n", (unsigned long long)app_config->seed);
+	
+	/*a single renderer thread owns the LED strip, it starts idle*/
+	set_render_lag(app_config->render_lag);
+	set_render_seed(app_config->seed);
+	if(start_cerebral_wars_renderer() == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	
+	/*the feature vectors are laid out once, the inputs and the processing share it*/
+	if(init_feature_layout(&feature_layout, app_config) == EXIT_FAILURE){
+		stop_cerebral_wars_renderer();
+		return EXIT_FAILURE;
+	}
+	
 	/*configure the feature input*/
-	if(configure_feature_input(feature_input, app_config) == EXIT_FAILURE){
+	if(configure_feature_input(feature_input, &feature_layout, app_config) == EXIT_FAILURE){
+		stop_cerebral_wars_renderer();
+		return EXIT_FAILURE;
+	}
+	
+	/*the profiles of the returning players are verified instead of trained*/
+	calib_profiles_init(&calib_profiles, NB_CHANNELS_USED);
+	if(app_config->calibration_profiles[0] != '\0' &&
+	   calib_profiles_load(&calib_profiles, app_config->calibration_profiles) == EXIT_FAILURE){
+		fprintf(stderr, "Calibration profiles ignored, they are replaced as the players train\n");
+	}
+	
+	/*a single thread waits on all the players' inputs*/
+	if(feat_mux_init(&input_mux, feature_input, NB_PLAYERS) == EXIT_FAILURE){
+		stop_cerebral_wars_renderer();
+		return EXIT_FAILURE;
+	}
+	
+	/*long-lived feature processing thread, it drives the mux*/
+	if(start_feat_proc_worker(&feat_worker, &input_mux, feature_proc) == EXIT_FAILURE){
+		stop_cerebral_wars_renderer();
 		return EXIT_FAILURE;
 	}
 	
@@ -112,14 +192,9 @@ int main(int argc, char *argv[])
 	ipc_comm[PLAYER_2].sem_key=PLAYER_2_SEM_KEY;
 	ipc_comm_init(&(ipc_comm[PLAYER_2]));
 	
-	/*configure threads*/
-	res = pthread_attr_init(&attr);
-	if (res != 0)
-		return EXIT_FAILURE;
-	
 	/*set beep mode*/
 	set_beep_mode(50, 0, 500);
-
+	
 	/*if required, wait for eeg hardware to be present*/
 	if(app_config->eeg_hardware_required){
 		if(!ipc_wait_for_harware(&(ipc_comm[PLAYER_1])) || 
@@ -137,8 +212,13 @@ int main(int argc, char *argv[])
 		/*set beep mode*/
 		set_beep_mode(50, 0, 500);
 		
-		/*wait for button pressed*/
-		wait_for_start_demo();
+		/*between games, the strip runs at a low rate and the inputs are parked*/
+		cerebral_wars_attract_mode();
+		
+		/*wait for button pressed, sleeping until it changes*/
+		if(!wait_for_start_demo()){
+			break;
+		}
 		
 		turn_off_beeper();
 	
@@ -150,22 +230,49 @@ int main(int argc, char *argv[])
 		
 		/*initialize feature processing*/
 		feature_proc[PLAYER_1].nb_train_samples = app_config->training_set_size;
+		feature_proc[PLAYER_1].nb_min_train_samples = app_config->training_min_size;
+		feature_proc[PLAYER_1].train_tolerance = app_config->training_tolerance;
+		feature_proc[PLAYER_1].baseline = calib_profiles_find(&calib_profiles, app_config->player_id[PLAYER_1]);
+		feature_proc[PLAYER_1].nb_verify_samples = app_config->verification_size;
+		feature_proc[PLAYER_1].verify_tolerance = app_config->profile_tolerance;
+		feature_proc[PLAYER_1].adapt_half_life = app_config->adaptive_half_life;
+		feature_proc[PLAYER_1].adapt_gate = app_config->adaptive_gate;
+		feature_proc[PLAYER_1].adapt_max_drift = app_config->adaptive_max_drift;
 		feature_proc[PLAYER_1].feature_input = &(feature_input[PLAYER_1]);
-		init_feat_processing(&(feature_proc[PLAYER_1]));
+		feature_proc[PLAYER_1].layout = &feature_layout;
+		if(init_feat_processing(&(feature_proc[PLAYER_1])) == EXIT_FAILURE){
+			status = EXIT_FAILURE;
+			break;
+		}
 		
 		feature_proc[PLAYER_2].nb_train_samples = app_config->training_set_size;
+		feature_proc[PLAYER_2].nb_min_train_samples = app_config->training_min_size;
+		feature_proc[PLAYER_2].train_tolerance = app_config->training_tolerance;
+		feature_proc[PLAYER_2].baseline = calib_profiles_find(&calib_profiles, app_config->player_id[PLAYER_2]);
+		feature_proc[PLAYER_2].nb_verify_samples = app_config->verification_size;
+		feature_proc[PLAYER_2].verify_tolerance = app_config->profile_tolerance;
+		feature_proc[PLAYER_2].adapt_half_life = app_config->adaptive_half_life;
+		feature_proc[PLAYER_2].adapt_gate = app_config->adaptive_gate;
+		feature_proc[PLAYER_2].adapt_max_drift = app_config->adaptive_max_drift;
 		feature_proc[PLAYER_2].feature_input = &(feature_input[PLAYER_2]);
-		init_feat_processing(&(feature_proc[PLAYER_2]));
+		feature_proc[PLAYER_2].layout = &feature_layout;
+		if(init_feat_processing(&(feature_proc[PLAYER_2])) == EXIT_FAILURE){
+			status = EXIT_FAILURE;
+			break;
+		}
 		
 			
-		/*start training*/	
-		pthread_create(&(threads_array[PLAYER_1]), &attr,
-					   train_player, (void*)&(feature_proc[PLAYER_1]));
-		pthread_create(&(threads_array[PLAYER_2]), &attr,
-					   train_player, (void*)&(feature_proc[PLAYER_2]));
-					   
-		pthread_join(threads_array[PLAYER_1], NULL);			   
-		pthread_join(threads_array[PLAYER_2], NULL);			   
+		/*train both players, frames are dispatched as they arrive*/	
+		if(feat_proc_worker_train(&feat_worker) == EXIT_FAILURE){
+			fprintf(stderr, "Training failed, feature input error\n");
+			status = EXIT_FAILURE;
+			break;
+		}
+		
+		/*the players trained in full are verified against this training next time*/
+		if(app_config->calibration_profiles[0] != '\0'){
+			store_calib_profiles(&calib_profiles, feature_proc, app_config);
+		}
 		
 		stop_cerebral_wars();
 		
@@ -174,109 +281,132 @@ int main(int argc, char *argv[])
 		fflush(stdout);	
 		sleep(3);	
 			
-		start = clock();
 		start_cerebral_wars();
+		cerebral_wars_countdown(GAME_START_DELAY);
 		task_running = 0x01;
+		game_phase = GAME_COUNTDOWN;
+		integrated_diff = 0.5;
+		for(i=0;i<NB_PLAYERS;i++){
+			last_sample_nb[i] = 0;
+			adjusted_sample[i] = 0;
+		}
+		
+		/*the game runs on fixed ticks, phases change on wall-clock deadlines*/
+		if(tick_scheduler_init(&game_sched, app_config->tick_rate) == EXIT_FAILURE){
+			status = EXIT_FAILURE;
+			break;
+		}
 			
 		/*run the test*/
 		while(task_running){
 			
+			elapsed_time = tick_scheduler_elapsed(&game_sched);
 			
-			if(game_started){
+			/*check if one of the phase deadlines is met*/
+			if(game_phase == GAME_COUNTDOWN && GAME_START_DELAY <= elapsed_time){
+				game_phase = GAME_PLAY;
+				cerebral_wars_effect(EFFECT_FLASH);
+				/*the worker starts publishing samples*/
+				feat_proc_worker_sample(&feat_worker);
+				next_integration = elapsed_time + app_config->integration_period;
+			}
 			
-				/*get a normalized sample*/
-				pthread_create(&(threads_array[PLAYER_1]), &attr,
-							   get_sample, (void*)&(feature_proc[PLAYER_1]));
-				pthread_create(&(threads_array[PLAYER_2]), &attr,
-							   get_sample, (void*)&(feature_proc[PLAYER_2]));
-							   
-				pthread_join(threads_array[PLAYER_1], NULL);		
-				pthread_join(threads_array[PLAYER_2], NULL);		
-				
-				/*show the value*/
-				printf("Player1.sample: %.3f\n",feature_proc[PLAYER_1].sample);
-				
-				/*add little offset to allow for negative values*/
-				feature_proc[PLAYER_1].sample = feature_proc[PLAYER_1].sample+0.2;
-				feature_proc[PLAYER_2].sample = feature_proc[PLAYER_2].sample+0.2;
-				
-				/*average over recent history*/
-				adjusted_sample[PLAYER_1] = (float)0.5*feature_proc[PLAYER_1].sample+0.5*adjusted_sample[PLAYER_1];
-				adjusted_sample[PLAYER_2] = (float)0.5*feature_proc[PLAYER_2].sample+0.5*adjusted_sample[PLAYER_2];
-				
-				/*report adjusted value*/
-				printf("Player1.adjsample: %.3f\n",adjusted_sample[PLAYER_1]);
-				
-				/*stub for tests*/
-				//adjusted_sample[PLAYER_2] = adjusted_sample[PLAYER_1]/2;
-				
-				/*make sure that values are within the range [0,1]*/
-				if(adjusted_sample[PLAYER_1]>1){
-					adjusted_sample[PLAYER_1] = 1;
-				}else if(adjusted_sample[PLAYER_1]<0){
-					adjusted_sample[PLAYER_1] = 0;
+			if(game_phase == GAME_PLAY && app_config->test_duration <= elapsed_time){
+				game_phase = GAME_FINISH;
+				/*the explosion was pushed toward the end of the strip by player 1*/
+				cerebral_wars_winner_mode(integrated_diff>0.5?PLAYER_1:PLAYER_2);
+				finish_time = elapsed_time + GAME_FINISH_DELAY;
+			}
+			
+			if(game_phase == GAME_PLAY){
+			
+				/*each player is updated as soon as its sample is published*/
+				for(i=0;i<NB_PLAYERS;i++){
+					
+					/*read the samples published by the worker, without blocking*/
+					sample_nb[i] = get_published_sample(&(feature_proc[i]), &(sample[i]));
+					
+					if(sample_nb[i] != last_sample_nb[i]){
+						last_sample_nb[i] = sample_nb[i];
+						
+						/*show the value*/
+						printf("Player%i.sample: %.3f\n",i+1,sample[i]);
+						
+						adjusted_sample[i] = adjust_sample(sample[i], adjusted_sample[i]);
+						
+						/*report adjusted value*/
+						printf("Player%i.adjsample: %.3f\n",i+1,adjusted_sample[i]);
+						
+						set_player_rate(adjusted_sample[i],i);
+					}
 				}
 				
-				if(adjusted_sample[PLAYER_2]>1){
-					adjusted_sample[PLAYER_2] = 1;
-				}else if(adjusted_sample[PLAYER_2]<0){
-					adjusted_sample[PLAYER_2] = 0;
+				/*integrate the difference on a fixed timestep, from the latest values*/
+				while(next_integration <= elapsed_time){
+					
+					integrated_diff += (adjusted_sample[PLAYER_1]-adjusted_sample[PLAYER_2])*app_config->integration_gain;
+					next_integration += app_config->integration_period;
+					
+					/*report the current value*/
+					printf("integrated_diff: %.3f\n",integrated_diff);
+					
+					/*update buzzer state*/
+					set_buzzer_state(running_avg);
+					set_explosion_location(integrated_diff);
 				}
 				
-				/*integrated the difference*/
-				integrated_diff += (adjusted_sample[PLAYER_1]-adjusted_sample[PLAYER_2])/75;
-				
-				/*report the current value*/
-				printf("integrated_diff: %.3f\n",integrated_diff);
-				
-				/*update buzzer state*/
-				set_buzzer_state(running_avg);
-				set_player_rate(adjusted_sample[PLAYER_1],PLAYER_1);
-				set_player_rate(adjusted_sample[PLAYER_2],PLAYER_2);
-				set_explosion_location(integrated_diff);
-				
-			}else{
+			}else if(game_phase == GAME_COUNTDOWN){
 				
 				set_player_rate(0.5,PLAYER_1);
 				set_player_rate(0.5,PLAYER_2);
 				set_explosion_location(integrated_diff);
-			}
-			
-			/*get current time*/
-			end = clock();
-			cpu_time_used = ((double) (end - start)) / (double)CLOCKS_PER_SEC * 100;
-			
-			/*check if one of the stop conditions is met*/
-			if(app_config->test_duration < cpu_time_used){
+				
+			}else if(finish_time <= elapsed_time){
 				task_running = 0x00;
-			}else if(GAME_START_DELAY < cpu_time_used){
-				game_started = 0x01;
 			}
 			
+			/*the renderer interpolates between the states published*/
+			publish_game_state();
+			
+			/*sleep until the next tick*/
+			tick_scheduler_wait(&game_sched);
 		}
 		
 		stop_cerebral_wars();
-		sleep(1);
 		
+		/*leave the inputs alone between games*/
+		feat_proc_worker_idle(&feat_worker);
+		
+		tick_scheduler_report(&game_sched, "Game loop");
+		
+		/*how far the references followed the drift*/
+		if(app_config->adaptive_half_life > 0.0){
+			for(i=0;i<NB_PLAYERS;i++){
+				report_reference_drift(&(feature_proc[i]), i);
+			}
+		}
 		printf("Finished\n");
 		
 	}
-
-	/*clean up app*/	
+	
+	/*clean up app, also when a game failed*/	
+	stop_cerebral_wars_renderer();
+	stop_feat_proc_worker(&feat_worker);
 	ipc_comm_cleanup(&(ipc_comm[PLAYER_1]));
 	clean_up_feat_processing(&(feature_proc[PLAYER_1]));
+	TERMINATE_FEAT_INPUT_FC(&(feature_input[PLAYER_1]));
 	ipc_comm_cleanup(&(ipc_comm[PLAYER_2]));
 	clean_up_feat_processing(&(feature_proc[PLAYER_2]));
+	TERMINATE_FEAT_INPUT_FC(&(feature_input[PLAYER_2]));
 	
-	return EXIT_SUCCESS;
+	return status;
 }
 
 
 
-int configure_feature_input(feature_input_t* feature_input, appconfig_t* app_config){
+int configure_feature_input(feature_input_t* feature_input, const feature_layout_t* feature_layout, appconfig_t* app_config){
 	
 	int i = 0;
-	int nb_features = 0;
 	
 	/*set the keys*/
 	feature_input[PLAYER_1].shm_key=PLAYER_1_SHM_KEY;
@@ -285,47 +415,109 @@ int configure_feature_input(feature_input_t* feature_input, appconfig_t* app_con
 	feature_input[PLAYER_2].shm_key=PLAYER_2_SHM_KEY;
 	feature_input[PLAYER_2].sem_key=PLAYER_2_SEM_KEY;
 	
-	/*compute the page size from the selected features*/
+	/*the page size follows from the layout of the selected features*/
 	
-	/*if timeseries are present*/
-	if(app_config->timeseries){
-		nb_features += app_config->window_width*app_config->nb_channels;
+	/*set buffer size related fields*/
+	for(i=0;i<NB_PLAYERS;i++){
+		feature_input[i].nb_features = feature_layout->nb_features;
+		feature_input[i].page_size = sizeof(frame_info_t)+feature_layout->nb_features*sizeof(double); 
+		feature_input[i].buffer_depth = app_config->buffer_depth;
+		feature_input[i].seed = app_config->seed;
+		feature_input[i].stream = INPUT_PRNG_STREAM+i;
+		
+		/*each player has its own source*/
+		if(init_feature_input(app_config->player_source[i], &(feature_input[i])) == EXIT_FAILURE){
+			fprintf(stderr, "Player %i: feature input init failed\n", i+1);
+			return EXIT_FAILURE;
+		}
 	}
 	
-	/*Fourier transform*/
-	if(app_config->fft){
-		/*one-sided fft is half window's width+1. multiplied by number of data channels*/
-		nb_features += app_config->window_width/2*app_config->nb_channels; 
-	}
 	
-	/*EEG Power bands*/
-	/*alpha*/
-	if(app_config->power_alpha){
-		nb_features += app_config->nb_channels;
-	}
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * double adjust_sample(double sample, double adjusted_sample)
+ * @brief smooth a player's new sample into its adjusted value
+ * @param sample, new normalized sample
+ * @param adjusted_sample, current adjusted value
+ * @return new adjusted value, within [0,1]
+ */
+static double adjust_sample(double sample, double adjusted_sample)
+{
+	/*add little offset to allow for negative values*/
+	sample = sample+0.2;
 	
-	/*beta*/
-	if(app_config->power_beta){
-		nb_features += app_config->nb_channels;
-	}
+	/*average over recent history*/
+	adjusted_sample = (float)0.5*sample+0.5*adjusted_sample;
 	
-	/*gamma*/
-	if(app_config->power_gamma){
-		nb_features += app_config->nb_channels;
+	/*make sure that values are within the range [0,1]*/
+	if(adjusted_sample>1){
+		adjusted_sample = 1;
+	}else if(adjusted_sample<0){
+		adjusted_sample = 0;
 	}
 	
-	/*set buffer size related fields*/
+	return adjusted_sample;
+}
+
+/**
+ * void store_calib_profiles(calib_profiles_t* calib_profiles, feat_proc_t* feature_proc, appconfig_t* app_config)
+ * @brief store the reference of the players that were trained in full and save the profiles
+ * @param calib_profiles, profiles of the players
+ * @param feature_proc, feature processing of each player, trained
+ * @param app_config, configuration of the app
+ */
+static void store_calib_profiles(calib_profiles_t* calib_profiles, feat_proc_t* feature_proc, appconfig_t* app_config)
+{
+	calib_profile_t profile;
+	char stored = 0x00;
+	int i, k;
+	
 	for(i=0;i<NB_PLAYERS;i++){
-		feature_input[i].nb_features = nb_features;
-		feature_input[i].page_size = sizeof(frame_info_t)+nb_features*sizeof(double); 
-		feature_input[i].buffer_depth = app_config->buffer_depth;
-		init_feature_input(app_config->feature_source, &(feature_input[i]));
+		
+		if(feature_proc[i].warm_started){
+			continue;
+		}
+		
+		profile.id = app_config->player_id[i];
+		profile.nb_samples = get_training_progress(&(feature_proc[i]), NULL);
+		profile.trained_at = (int64_t)time(NULL);
+		profile.nb_features = NB_CHANNELS_USED;
+		for(k=0;k<NB_CHANNELS_USED;k++){
+			profile.mean[k] = feature_proc[i].mean[k];
+			profile.std_dev[k] = feature_proc[i].std_dev[k];
+		}
+		
+		if(calib_profiles_store(calib_profiles, &profile) == EXIT_SUCCESS){
+			stored = 0x01;
+		}
 	}
 	
-
-	return EXIT_SUCCESS;
+	if(stored && calib_profiles_save(calib_profiles, app_config->calibration_profiles) == EXIT_FAILURE){
+		fprintf(stderr, "Calibration profiles could not be saved to %s\n", app_config->calibration_profiles);
+	}
 }
 
+/**
+ * void report_reference_drift(feat_proc_t* feature_proc, int player)
+ * @brief print how far the reference of a player moved during the game
+ * @param feature_proc, feature processing of the player
+ * @param player, index of the player
+ */
+static void report_reference_drift(feat_proc_t* feature_proc, int player)
+{
+	double drift[NB_CHANNELS_USED];
+	double max_drift;
+	unsigned int nb_gated;
+	unsigned int nb_samples;
+	
+	nb_samples = get_reference_drift(feature_proc, drift, &max_drift, &nb_gated);
+	
+	printf("Player%i reference drift: %.2f, %.2f std (max %.2f), %u of %u samples gated\n",
+		   player+1, drift[0], drift[1], max_drift, nb_gated, nb_samples);
+}
 
 /**
  * print_banner()
@@ -350,7 +542,7 @@ static void print_banner()
  */
 char *which_config(int argc, char **argv)
 {
-
+	
 	if (argc == 2) {
 		return argv[1];
 	} else {
@@ -359,29 +551,6 @@ char *which_config(int argc, char **argv)
 }
 
 
-/**
- * void* train_player(void* param)
- * @brief thread that trains a player
- * @param param, (feat_proc_t*) player to train
- * @return NULL
- */
-void* train_player(void* param){
-	train_feat_processing((feat_proc_t*)param);
-	return NULL;
-}
-
-/**
- * void* train_player(void* param)
- * @brief thread that gets a sample for a player
- * @param param, (feat_proc_t*) player to train
- * @return NULL
- */
-void* get_sample(void* param){
-	get_normalized_sample((feat_proc_t*)param);
-	return NULL;
-}
-
-
 
 
 
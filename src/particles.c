@@ -0,0 +1,251 @@
+/**
+ * @file particles.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Particles of the players, simulated as entities instead of pixels.
+ * They are advanced once per frame and rasterized into the frame, so the cost
+ * depends on the number of particles and not on the length of the strip.
+ * The kinematics are in fixed point, such that speeds are continuous without
+ * floating point in the frame loop.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "particles.h"
+
+/*brightness along the particle, from the head*/
+static const uint8_t particle_kernel[PARTICLE_LENGTH] = {255, 30, 15, 0};
+
+/*
+ * Brightness of the PARTICLE_LENGTH+1 LEDs covered by a particle, from the LED
+ * ahead of the head, for each sub-pixel step of its position. Built once.
+ */
+static uint8_t subpixel_kernel[SUBPIXEL_STEPS][PARTICLE_LENGTH+1];
+static char subpixel_kernel_built = 0x00;
+
+static void build_subpixel_kernel();
+static void particles_remove(particle_list_t* list, int idx);
+
+/**
+ * void particles_init(particle_list_t* list, int entry, int direction, const pixel_t* color, int nb_leds)
+ * @brief initialize an empty list of particles
+ * @param list, reference to the list
+ * @param entry, LED where the particles are spawned
+ * @param direction, SEGMENT_ASCENDING or SEGMENT_DESCENDING
+ * @param color, color of the particles at full intensity
+ * @param nb_leds, number of LEDs of the strip, visible until advanced
+ */
+void particles_init(particle_list_t* list, int entry, int direction, const pixel_t* color, int nb_leds){
+	
+	list->entry = entry;
+	list->direction = direction;
+	list->color = *color;
+	list->first = 0;
+	list->last = nb_leds-1;
+	list->nb_particles = 0;
+	
+	if(!subpixel_kernel_built){
+		build_subpixel_kernel();
+	}
+}
+
+/**
+ * int particles_spawn(particle_list_t* list, int32_t speed, uint8_t intensity)
+ * @brief spawn a new particle at the entry
+ * @param list, reference to the list
+ * @param speed, LEDs per frame, Q16
+ * @param intensity, brightness of the particle
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the list is full
+ */
+int particles_spawn(particle_list_t* list, int32_t speed, uint8_t intensity){
+	
+	int idx = list->nb_particles;
+	
+	if(idx >= MAX_PARTICLES){
+		return EXIT_FAILURE;
+	}
+	
+	list->position[idx] = INT_TO_Q16(list->entry);
+	list->speed[idx] = speed;
+	list->intensity[idx] = intensity;
+	list->age[idx] = 0;
+	list->nb_particles++;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * char particles_entry_clear(const particle_list_t* list)
+ * @brief check if the last particle spawned has completely left the entry
+ * @param list, reference to the list
+ * @return 0x01 if a new particle can be spawned, 0x00 otherwise
+ */
+char particles_entry_clear(const particle_list_t* list){
+	
+	int i;
+	int32_t distance;
+	
+	for(i=0;i<list->nb_particles;i++){
+		distance = (list->position[i]-INT_TO_Q16(list->entry))*list->direction;
+		if(distance < INT_TO_Q16(PARTICLE_LENGTH)){
+			return 0x00;
+		}
+	}
+	
+	return 0x01;
+}
+
+/**
+ * void particles_advance(particle_list_t* list, int first, int last)
+ * @brief move the particles by one frame and remove those that have left the visible range
+ * @param list, reference to the list
+ * @param first, first visible LED
+ * @param last, last visible LED
+ */
+void particles_advance(particle_list_t* list, int first, int last){
+	
+	int i = 0;
+	int tail;
+	
+	list->first = first;
+	list->last = last;
+	
+	while(i<list->nb_particles){
+		
+		list->position[i] += list->direction*list->speed[i];
+		list->age[i]++;
+		
+		/*remove once the tail went past the far end*/
+		tail = Q16_TO_INT(list->position[i]) - list->direction*(PARTICLE_LENGTH-1);
+		if((list->direction == SEGMENT_ASCENDING && tail > last) ||
+		   (list->direction == SEGMENT_DESCENDING && tail < first)){
+			particles_remove(list, i);
+		}else{
+			i++;
+		}
+	}
+}
+
+/**
+ * char particles_in_range(const particle_list_t* list, int low, int high)
+ * @brief check if any visible part of a particle is between two LEDs
+ * @param list, reference to the list
+ * @param low, lowest LED of the range
+ * @param high, highest LED of the range
+ * @return 0x01 if a particle is in range, 0x00 otherwise
+ */
+char particles_in_range(const particle_list_t* list, int low, int high){
+	
+	int i;
+	int head;
+	int tail;
+	
+	/*only the visible part counts*/
+	if(low < list->first){
+		low = list->first;
+	}
+	if(high > list->last){
+		high = list->last;
+	}
+	
+	for(i=0;i<list->nb_particles;i++){
+		
+		head = Q16_TO_INT(list->position[i]);
+		tail = head - list->direction*(PARTICLE_LENGTH-2); /*last lit LED*/
+		
+		if((head >= low || tail >= low) && (head <= high || tail <= high)){
+			return 0x01;
+		}
+	}
+	
+	return 0x00;
+}
+
+/**
+ * void particles_rasterize(const particle_list_t* list, pixel_t* frame)
+ * @brief paint the particles in the visible range of the frame, the frame must
+ *        have been cleared beforehand. Each particle is spread over the LEDs 
+ *        it covers, from its sub-pixel position.
+ * @param list, reference to the list
+ * @param frame, frame of the strip
+ */
+void particles_rasterize(const particle_list_t* list, pixel_t* frame){
+	
+	int i;
+	int k;
+	int led;
+	int level;
+	int head;
+	const uint8_t* kernel;
+	
+	for(i=0;i<list->nb_particles;i++){
+		
+		/*the LED ahead of the head lights up as the particle moves toward it*/
+		if(list->direction == SEGMENT_ASCENDING){
+			head = Q16_TO_INT(list->position[i]);
+			kernel = subpixel_kernel[(list->position[i]&(Q16_ONE-1))>>(Q16_SHIFT-SUBPIXEL_BITS)];
+		}else{
+			head = Q16_TO_INT(list->position[i]+Q16_ONE-1);
+			kernel = subpixel_kernel[((-list->position[i])&(Q16_ONE-1))>>(Q16_SHIFT-SUBPIXEL_BITS)];
+		}
+		
+		for(k=0;k<=PARTICLE_LENGTH;k++){
+			
+			led = head + list->direction*(1-k);
+			
+			if(led < list->first || led > list->last || kernel[k] == 0){
+				continue;
+			}
+			
+			level = kernel[k]*list->intensity[i]/255;
+			frame[led].red = list->color.red*level/255;
+			frame[led].green = list->color.green*level/255;
+			frame[led].blue = list->color.blue*level/255;
+		}
+	}
+}
+
+/**
+ * void build_subpixel_kernel()
+ * @brief compute the brightness of the LEDs covered by a particle, for each 
+ *        sub-pixel step. Each LED of the particle kernel is split between its
+ *        LED and the next one, in proportion of the step.
+ */
+static void build_subpixel_kernel(){
+	
+	int step;
+	int k;
+	int ahead;
+	int behind;
+	
+	for(step=0;step<SUBPIXEL_STEPS;step++){
+		for(k=0;k<=PARTICLE_LENGTH;k++){
+			
+			/*the part of kernel LED k that moved ahead, and the part of k-1 left behind*/
+			ahead = k<PARTICLE_LENGTH?particle_kernel[k]*step:0;
+			behind = k>0?particle_kernel[k-1]*(SUBPIXEL_STEPS-step):0;
+			
+			subpixel_kernel[step][k] = (ahead+behind+SUBPIXEL_STEPS/2)/SUBPIXEL_STEPS;
+		}
+	}
+	
+	subpixel_kernel_built = 0x01;
+}
+
+/**
+ * void particles_remove(particle_list_t* list, int idx)
+ * @brief remove a particle, by moving the last one in its place
+ * @param list, reference to the list
+ * @param idx, index of the particle
+ */
+static void particles_remove(particle_list_t* list, int idx){
+	
+	int last = list->nb_particles-1;
+	
+	list->position[idx] = list->position[last];
+	list->speed[idx] = list->speed[last];
+	list->intensity[idx] = list->intensity[last];
+	list->age[idx] = list->age[last];
+	list->nb_particles--;
+}
@@ -11,15 +11,33 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <errno.h>
 
 #include "feature_structure.h"
 #include "fake_feature_generator.h"
 #include "feature_input.h"
 
 #define SAMPLE_LENGTH 220
+#define FAKE_SAMPLE_PERIOD_NS 500000000L /*simulated delay between samples*/
 
 extern double randn();
 
+/*operations of the fake feature generator backend*/
+const feature_input_ops_t fake_feat_gen_ops = {
+	.name = "FAKE",
+	.init = &fake_feat_gen_init,
+	.request = &fake_feat_gen_request,
+	.wait = &fake_feat_gen_wait_for_request_completed,
+	.poll = &fake_feat_gen_poll_request_completed,
+	.get_frame_info = &fake_feat_gen_frame_info_ref,
+	.get_fvect_info = &fake_feat_gen_feature_array_ref,
+	.terminate = &fake_feat_gen_cleanup,
+	.park = NULL,
+	.unpark = NULL,
+	.release = NULL
+};
+
 /**
  * int fake_feat_gen_init(void *param)
  * @brief init fake feature generator memory
@@ -30,35 +48,76 @@ int fake_feat_gen_init(void *param){
 	
 	feature_input_t* pfeature_input = param;
 	pfeature_input->shm_buf = malloc(pfeature_input->page_size);
-	/*nothing to do*/
+	if(pfeature_input->shm_buf == NULL){
+		return EXIT_FAILURE;
+	}
+	
+	/*the same seed gives the same samples*/
+	prng_seed(&(pfeature_input->prng), pfeature_input->seed, pfeature_input->stream);
+	
+	/*first sample is available right away*/
+	clock_gettime(CLOCK_MONOTONIC, &(pfeature_input->ready_time));
 	return EXIT_SUCCESS;
 }
 
 /**
- * int fake_feat_gen_request()
- * @brief request a new sample (do nothing)
+ * int fake_feat_gen_request(void *param)
+ * @brief request a new sample, it will be ready after a simulated delay
  * @param reference to the feature input
  * @return EXIT_FAILURE/EXIT_SUCCESS
  */
-int fake_feat_gen_request(void *param __attribute__((unused))){
+int fake_feat_gen_request(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	
+	clock_gettime(CLOCK_MONOTONIC, &(pfeature_input->ready_time));
+	pfeature_input->ready_time.tv_nsec += FAKE_SAMPLE_PERIOD_NS;
+	if(pfeature_input->ready_time.tv_nsec >= 1000000000L){
+		pfeature_input->ready_time.tv_nsec -= 1000000000L;
+		pfeature_input->ready_time.tv_sec++;
+	}
 	
 	return EXIT_SUCCESS;
 }
 
 /**
  * int fake_feat_gen_wait_for_request_completed(void *param)
- * @brief return a random sample, and sleep a bit to simulate a delay
+ * @brief sleep until the requested sample is ready, to simulate a delay
  * @param reference to the feature input
  * @return EXIT_FAILURE/EXIT_SUCCESS
  */
-int fake_feat_gen_wait_for_request_completed(void *param __attribute__((unused))){
+int fake_feat_gen_wait_for_request_completed(void *param){
+	
+	feature_input_t* pfeature_input = param;
 	
 	/*wait to simulate a delay*/
-	usleep(500000);
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &(pfeature_input->ready_time), NULL) == EINTR);
 	
 	return EXIT_SUCCESS;
 }
 
+/**
+ * int fake_feat_gen_poll_request_completed(void *param)
+ * @brief non-blocking version of fake_feat_gen_wait_for_request_completed
+ * @param reference to the feature input
+ * @return EXIT_SUCCESS if the sample is ready, FEAT_INPUT_PENDING otherwise
+ */
+int fake_feat_gen_poll_request_completed(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	if(now.tv_sec > pfeature_input->ready_time.tv_sec ||
+	   (now.tv_sec == pfeature_input->ready_time.tv_sec && 
+	    now.tv_nsec >= pfeature_input->ready_time.tv_nsec)){
+		return EXIT_SUCCESS;
+	}
+	
+	return FEAT_INPUT_PENDING;
+}
+
 
 /**
  * double* fake_feat_gen_feature_array_ref(void *param)
@@ -72,7 +131,7 @@ frame_info_t* fake_feat_gen_frame_info_ref(void *param){
 	frame_info_t* frame_info = (frame_info_t*)pfeature_input->shm_buf;
 	
 	/*randomly generate 10% of blinks*/
-	if((double)rand()/(double)RAND_MAX < 0.1){
+	if(prng_next(&(pfeature_input->prng)) < PRNG_CHANCE(0.1)){
 		frame_info->eye_blink_detected = 0x01;
 	}else{
 		frame_info->eye_blink_detected = 0x00;
@@ -90,14 +149,11 @@ frame_info_t* fake_feat_gen_frame_info_ref(void *param){
  */
 double* fake_feat_gen_feature_array_ref(void *param){
 	
-	int i=0;
 	feature_input_t* pfeature_input = param;
 	double* feature_array = (double*)&(pfeature_input->shm_buf[sizeof(frame_info_t)]);
 	
 	/*file the buffer with random values*/
-	for(i=0;i<pfeature_input->nb_features;i++){
-		feature_array[i] = (double)rand()/(double)RAND_MAX;
-	}
+	prng_uniform_batch(&(pfeature_input->prng), feature_array, pfeature_input->nb_features);
 
 	return feature_array;
 }
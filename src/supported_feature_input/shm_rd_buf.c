@@ -13,11 +13,51 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/sem.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <linux/futex.h>
 
 #include "feature_structure.h"
 #include "feature_input.h"
 #include "shm_rd_buf.h"
 
+/*operations of the shared memory backend*/
+const feature_input_ops_t shm_rd_ops = {
+	.name = "SHM",
+	.init = &shm_rd_init,
+	.request = &shm_rd_request,
+	.wait = &shm_rd_wait_for_request_completed,
+	.poll = &shm_rd_poll_request_completed,
+	.get_frame_info = &shm_get_frame_info_ref,
+	.get_fvect_info = &shm_get_feature_array_ref,
+	.terminate = &shm_rd_cleanup,
+	.park = &shm_rd_park,
+	.unpark = &shm_rd_unpark,
+	.release = NULL
+};
+
+/*operations of the shared memory ring backend*/
+const feature_input_ops_t shm_ring_ops = {
+	.name = "SHM_RING",
+	.init = &shm_ring_init,
+	.request = &shm_ring_request,
+	.wait = &shm_ring_wait_for_request_completed,
+	.poll = &shm_ring_poll_request_completed,
+	.get_frame_info = &shm_ring_get_frame_info_ref,
+	.get_fvect_info = &shm_ring_get_feature_array_ref,
+	.terminate = &shm_ring_cleanup,
+	.park = &shm_ring_park,
+	.unpark = &shm_ring_unpark,
+	.release = &shm_ring_release
+};
+
+static void* shm_rd_waiter(void *param);
+static void shm_report_stats(feature_input_t* pfeature_input);
+static int shm_ring_take_page(feature_input_t* pfeature_input);
+
 /**
  * int shm_rd_init(void *param)
  * @brief Setups the shared memory input (memory and semaphores linkage)
@@ -61,12 +101,22 @@ int shm_rd_init(void *param){
 	/*set as if the current page was the last, such that the next page read will
 	  be the first one*/
 	pfeature_input->current_page = pfeature_input->buffer_depth-1;
-
+	
 	/*set all semaphores to 0*/
 	for(i=0;i<4;i++){
 		semctl(pfeature_input->semid, i, SETVAL, 0);
 	}
-
+	
+	/*the waiter takes the pages as they are written, see shm_rd_buf.h*/
+	pfeature_input->sem_arrived = 0;
+	pfeature_input->sem_taken = 0;
+	pfeature_input->sem_stop = 0x00;
+	pfeature_input->sem_failed = 0x00;
+	if(pthread_create(&(pfeature_input->sem_waiter), NULL, shm_rd_waiter, param) != 0){
+		perror("SHM: waiter");
+		return EXIT_FAILURE;
+	}
+	
 	return EXIT_SUCCESS;
 }
 
@@ -94,12 +144,13 @@ int shm_rd_request(void *param){
 	pfeature_input->sops->sem_flg = IPC_NOWAIT;
 	semop(pfeature_input->semid, pfeature_input->sops, 1);
 	
+	__atomic_add_fetch(&(pfeature_input->nb_syscalls), 2, __ATOMIC_RELAXED);
 	return EXIT_SUCCESS;
 }
 
 
 /**
- * int shm_rd_request(void *param)
+ * int shm_rd_wait_for_request_completed(void *param)
  * @brief Blocking call, until a sample has arrived
  * @param param, reference to the feature input struct
  * @return EXIT_FAILURE for unknown type, EXIT_SUCCESS for known/success
@@ -107,21 +158,127 @@ int shm_rd_request(void *param){
 int shm_rd_wait_for_request_completed(void *param){
 	
 	feature_input_t* pfeature_input = param;
+	int res;
+	
+	/*sleep until the waiter has taken a page*/
+	while((res = shm_rd_poll_request_completed(param)) == FEAT_INPUT_PENDING){
+		
+		__atomic_add_fetch(&(pfeature_input->nb_syscalls), 1, __ATOMIC_RELAXED);
+		if(syscall(SYS_futex, &(pfeature_input->sem_arrived), FUTEX_WAIT, pfeature_input->sem_taken, NULL, NULL, 0) != 0 &&
+		   errno != EAGAIN && errno != EINTR){
+			perror("SHM: futex wait");
+			return EXIT_FAILURE;
+		}
+	}
 	
-	/*wait for features to be ready*/
-	pfeature_input->sops->sem_num = PREPROC_OUT_READY; 
-	pfeature_input->sops->sem_op = -1;
-	pfeature_input->sops->sem_flg = 0;	
+	return res;
+}
+
+/**
+ * int shm_rd_poll_request_completed(void *param)
+ * @brief Non-blocking version of shm_rd_wait_for_request_completed
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS if the sample has arrived, FEAT_INPUT_PENDING if not yet, 
+ *         EXIT_FAILURE on error
+ */
+int shm_rd_poll_request_completed(void *param){
 	
-	if(semop(pfeature_input->semid, pfeature_input->sops, 1) != 0){
+	feature_input_t* pfeature_input = param;
+	
+	/*the counter is meaningless once the waiter failed*/
+	if(__atomic_load_n(&(pfeature_input->sem_failed), __ATOMIC_ACQUIRE)){
 		return EXIT_FAILURE;
 	}
 	
+	/*pages taken by the waiter that were not read yet*/
+	if(__atomic_load_n(&(pfeature_input->sem_arrived), __ATOMIC_ACQUIRE) == pfeature_input->sem_taken){
+		return FEAT_INPUT_PENDING;
+	}
+	
+	pfeature_input->sem_taken++;
+	pfeature_input->nb_pages++;
+	
 	/*update page id*/
 	pfeature_input->current_page += 1;
 	pfeature_input->current_page %= pfeature_input->buffer_depth;
 	return EXIT_SUCCESS;
+}
+
+/**
+ * uint32_t* shm_rd_park(void *param, uint32_t *expected)
+ * @brief Get the futex word the waiter increments for each page it takes,
+ *        the caller may sleep on it until it changes
+ * @param param, reference to the feature input struct
+ * @param expected(out), value of the futex word while no page has arrived
+ * @return futex word to sleep on
+ */
+uint32_t* shm_rd_park(void *param, uint32_t *expected){
 	
+	feature_input_t* pfeature_input = param;
+	
+	*expected = pfeature_input->sem_taken;
+	return &(pfeature_input->sem_arrived);
+}
+
+/**
+ * int shm_rd_unpark(void *param)
+ * @brief Nothing to undo, the waiter always wakes the futex word
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS
+ */
+int shm_rd_unpark(void *param){
+	(void)param;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * void* shm_rd_waiter(void *param)
+ * @brief Waiter thread, blocks on the semaphore of the written pages and
+ *        counts each one in a futex word, such that the reader can sleep
+ *        on it along with other inputs. Only the system calls that bring a
+ *        page are counted, to compare the transports.
+ * @param param, reference to the feature input struct
+ * @return NULL
+ */
+static void* shm_rd_waiter(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	struct sembuf sop = {PREPROC_OUT_READY, -1, 0};
+	
+	while(1){
+		
+		if(semop(pfeature_input->semid, &sop, 1) != 0){
+			
+			if(errno == EINTR){
+				continue;
+			}
+			
+			/*the set is removed when the preprocessing or this process exits*/
+			if(errno != EIDRM){
+				perror("SHM: semop");
+			}
+			
+			/*no page is counted, the reader finds the failure on its next poll.
+			  The failure bit still changes the word, such that a reader about
+			  to sleep on it doesn't miss the wake*/
+			__atomic_store_n(&(pfeature_input->sem_failed), 0x01, __ATOMIC_SEQ_CST);
+			__atomic_or_fetch(&(pfeature_input->sem_arrived), SHM_WAITER_FAILED, __ATOMIC_SEQ_CST);
+			syscall(SYS_futex, &(pfeature_input->sem_arrived), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+			break;
+		}
+		
+		/*posted by shm_rd_cleanup*/
+		if(__atomic_load_n(&(pfeature_input->sem_stop), __ATOMIC_ACQUIRE)){
+			break;
+		}
+		
+		/*the kernel checks the word again, so the wake cannot be missed*/
+		__atomic_add_fetch(&(pfeature_input->sem_arrived), 1, __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&(pfeature_input->nb_syscalls), 2, __ATOMIC_RELAXED);
+		syscall(SYS_futex, &(pfeature_input->sem_arrived), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	}
+	
+	return NULL;
 }
 
 /**
@@ -162,6 +319,317 @@ double* shm_get_feature_array_ref(void *param){
 int shm_rd_cleanup(void *param){
 	
 	feature_input_t* pfeature_input = param;
+	struct sembuf sop = {PREPROC_OUT_READY, 1, IPC_NOWAIT};
+	
+	/*wake the waiter, it already returned if the set was removed*/
+	__atomic_store_n(&(pfeature_input->sem_stop), 0x01, __ATOMIC_RELEASE);
+	semop(pfeature_input->semid, &sop, 1);
+	pthread_join(pfeature_input->sem_waiter, NULL);
+	
+	shm_report_stats(pfeature_input);
+	
+	/* Detach the shared memory segment. */
+	shmdt(pfeature_input->shm_buf);
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * void shm_report_stats(feature_input_t* pfeature_input)
+ * @brief Report the transport cost, to compare the semaphore and ring protocols
+ * @param pfeature_input, reference to the feature input struct
+ */
+static void shm_report_stats(feature_input_t* pfeature_input){
+	
+	double syscalls_per_page = 0.0;
+	
+	if(pfeature_input->nb_pages>0){
+		syscalls_per_page = (double)pfeature_input->nb_syscalls/(double)pfeature_input->nb_pages;
+	}
+	
+	printf("%s: %u pages read, %.2f syscalls/page\n", pfeature_input->ops->name,
+		   pfeature_input->nb_pages, syscalls_per_page);
+}
+
+
+/**
+ * shm_ring_hdr_t* shm_ring_hdr(feature_input_t* pfeature_input)
+ * @brief Get the ring header, at the beginning of the shared memory
+ * @param pfeature_input, reference to the feature input struct
+ * @return reference to the ring header
+ */
+static shm_ring_hdr_t* shm_ring_hdr(feature_input_t* pfeature_input){
+	return (shm_ring_hdr_t*)pfeature_input->shm_buf;
+}
+
+/**
+ * int shm_ring_init(void *param)
+ * @brief Setups the shared memory ring input. The header is initialized if this is
+ *        the first process to attach, otherwise its geometry is validated and
+ *        the pages left from a previous session are released.
+ * @param param, reference to the feature input struct
+ * @return EXIT_FAILURE for failure, EXIT_SUCCESS for success
+ */
+int shm_ring_init(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr;
+	int shm_size = SHM_RING_HDR_SIZE+pfeature_input->buffer_depth*pfeature_input->page_size;
+	
+	/*initialise the shared memory array, header page first*/
+	if ((pfeature_input->shmid = shmget(pfeature_input->shm_key, shm_size, IPC_CREAT | 0666)) < 0) {
+		perror("shmget");
+		return EXIT_FAILURE;
+	}
+	
+	/*Now we attach it to our data space.*/
+	if ((pfeature_input->shm_buf = shmat(pfeature_input->shmid, NULL, 0)) == (char *) -1) {
+		perror("shmat");
+		return EXIT_FAILURE;
+	}
+	
+	hdr = shm_ring_hdr(pfeature_input);
+	
+	if(__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC){
+		
+		/*first to attach, set the geometry*/
+		hdr->version = SHM_RING_VERSION;
+		hdr->page_size = pfeature_input->page_size;
+		hdr->buffer_depth = pfeature_input->buffer_depth;
+		hdr->head = 0;
+		hdr->nb_dropped = 0;
+		hdr->tail = 0;
+		hdr->reader_parked = 0;
+		__atomic_store_n(&hdr->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+		
+	}else if(hdr->version != SHM_RING_VERSION ||
+			 hdr->page_size != (uint32_t)pfeature_input->page_size ||
+			 hdr->buffer_depth != (uint32_t)pfeature_input->buffer_depth){
+		
+		fprintf(stderr, "SHM_RING: ring geometry mismatch (version %u, page size %u, depth %u)\n",
+				hdr->version, hdr->page_size, hdr->buffer_depth);
+		shmdt(pfeature_input->shm_buf);
+		return EXIT_FAILURE;
+		
+	}else{
+		/*drop pages left from a previous session*/
+		__atomic_store_n(&hdr->tail, __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+	}
+	
+	pfeature_input->page_held = 0x00;
+	pfeature_input->current_page = 0;
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * int shm_ring_request(void *param)
+ * @brief Give back the page currently held, if any, for the writer to fill it again.
+ *        The writer publishes continuously, there is nothing else to open.
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS
+ */
+int shm_ring_request(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	
+	if(pfeature_input->page_held){
+		__atomic_store_n(&hdr->tail, hdr->tail+1, __ATOMIC_RELEASE);
+		pfeature_input->page_held = 0x00;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * int shm_ring_wait_for_request_completed(void *param)
+ * @brief Blocking call, until a page is published. Only sleeps in the kernel
+ *        when the ring is empty.
+ * @param param, reference to the feature input struct
+ * @return EXIT_FAILURE for failure, EXIT_SUCCESS for success
+ */
+int shm_ring_wait_for_request_completed(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	uint32_t tail = hdr->tail;
+	
+	while(shm_ring_take_page(pfeature_input) == FEAT_INPUT_PENDING){
+		
+		/*announce that we are going to sleep, then check again to close the race,
+		  the fence keeps the load of head after the store, see shm_rd_buf.h*/
+		__atomic_store_n(&hdr->reader_parked, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		
+		if(__atomic_load_n(&hdr->head, __ATOMIC_RELAXED) == tail){
+			
+			pfeature_input->nb_syscalls++;
+			/*the kernel checks head again, so a publication cannot be missed*/
+			if(syscall(SYS_futex, &hdr->head, FUTEX_WAIT, tail, NULL, NULL, 0) != 0 &&
+			   errno != EAGAIN && errno != EINTR){
+				perror("SHM_RING: futex wait");
+				__atomic_store_n(&hdr->reader_parked, 0, __ATOMIC_RELAXED);
+				return EXIT_FAILURE;
+			}
+		}
+		
+		__atomic_store_n(&hdr->reader_parked, 0, __ATOMIC_RELAXED);
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * int shm_ring_poll_request_completed(void *param)
+ * @brief Non-blocking version of shm_ring_wait_for_request_completed
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS if a page is held, FEAT_INPUT_PENDING otherwise
+ */
+int shm_ring_poll_request_completed(void *param){
+	return shm_ring_take_page((feature_input_t*)param);
+}
+
+
+/**
+ * uint32_t* shm_ring_park(void *param, uint32_t *expected)
+ * @brief Prepare to sleep until the writer publishes a page. The writer is told
+ *        to wake us up, the caller must then sleep on the returned futex word
+ *        (or check it again) and call shm_ring_unpark.
+ * @param param, reference to the feature input struct
+ * @param expected(out), value of the futex word while the ring is empty
+ * @return futex word to sleep on
+ */
+uint32_t* shm_ring_park(void *param, uint32_t *expected){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	
+	*expected = hdr->tail;
+	
+	/*the kernel loads head with a plain load, the fence keeps it after the store*/
+	__atomic_store_n(&hdr->reader_parked, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	
+	return &hdr->head;
+}
+
+
+/**
+ * int shm_ring_unpark(void *param)
+ * @brief Tells the writer we are awake again
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS
+ */
+int shm_ring_unpark(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	
+	__atomic_store_n(&hdr->reader_parked, 0, __ATOMIC_RELAXED);
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * int shm_ring_release(void *param)
+ * @brief Give back the page held and drop the pages published, the next request
+ *        starts from a fresh page. While no request is made, the writer fills the
+ *        ring and drops its samples, without waking us up.
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS
+ */
+int shm_ring_release(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	
+	pfeature_input->page_held = 0x00;
+	__atomic_store_n(&hdr->tail, __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * int shm_ring_take_page(feature_input_t* pfeature_input)
+ * @brief Take ownership of the oldest published page, if any
+ * @param pfeature_input, reference to the feature input struct
+ * @return EXIT_SUCCESS if a page is held, FEAT_INPUT_PENDING otherwise
+ */
+static int shm_ring_take_page(feature_input_t* pfeature_input){
+	
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	uint32_t tail = hdr->tail;
+	
+	/*a page still held is still the current one*/
+	if(pfeature_input->page_held){
+		return EXIT_SUCCESS;
+	}
+	
+	if(__atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE) == tail){
+		return FEAT_INPUT_PENDING;
+	}
+	
+	/*the oldest published page is ours until the next request*/
+	pfeature_input->current_page = tail % pfeature_input->buffer_depth;
+	pfeature_input->page_held = 0x01;
+	pfeature_input->nb_pages++;
+	
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * frame_info_t* shm_ring_get_frame_info_ref(void *param)
+ * @brief Call to get a reference to the frame info of the held page
+ * @param param, reference to the feature input struct
+ * @return references to the frame info
+ */
+frame_info_t* shm_ring_get_frame_info_ref(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	/*compute offset of current page, after the header*/
+	int offset = SHM_RING_HDR_SIZE + pfeature_input->current_page*pfeature_input->page_size;
+	return (frame_info_t*)&(pfeature_input->shm_buf[offset]);
+}
+
+
+/**
+ * double* shm_ring_get_feature_array_ref(void *param)
+ * @brief Call to get a reference to the feature vector of the held page
+ * @param param, reference to the feature input struct
+ * @return reference to the feature vector
+ */
+double* shm_ring_get_feature_array_ref(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	/*compute offset of current page, after the header, and skip frame info*/
+	int offset = SHM_RING_HDR_SIZE + pfeature_input->current_page*pfeature_input->page_size + sizeof(frame_info_t);
+	return (double*)&(pfeature_input->shm_buf[offset]);
+}
+
+
+/**
+ * int shm_ring_cleanup(void *param)
+ * @brief Give back the held page and detach from the shared memory
+ * @param param, reference to the feature input struct
+ * @return EXIT_SUCCESS
+ */
+int shm_ring_cleanup(void *param){
+	
+	feature_input_t* pfeature_input = param;
+	shm_ring_hdr_t* hdr = shm_ring_hdr(pfeature_input);
+	
+	shm_ring_request(pfeature_input);
+	
+	shm_report_stats(pfeature_input);
+	printf("%s: %u samples dropped by the writer\n", pfeature_input->ops->name,
+		   __atomic_load_n(&hdr->nb_dropped, __ATOMIC_RELAXED));
 	
 	/* Detach the shared memory segment. */
 	shmdt(pfeature_input->shm_buf);
@@ -0,0 +1,124 @@
+/**
+ * @file file_led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief LED output to a frame log file, mapped in memory. The log keeps the
+ *        last frames sent with their time, to replay or study the frame pacing.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "file_led_output.h"
+
+/*operations of the frame log backend*/
+const led_output_ops_t file_led_output_ops = {
+	.name = "FILE",
+	.open = &file_led_output_open,
+	.write = &file_led_output_write,
+	.close = &file_led_output_close,
+	.prefix_updates = 0
+};
+
+/**
+ * int file_led_output_open(void *param)
+ * @brief create the log file, at its full size, and map it
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int file_led_output_open(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	led_log_hdr_t* hdr;
+	size_t record_size = LED_LOG_RECORD_SIZE(led_output->frame_size);
+	
+	led_output->fd = open(led_output->target, O_RDWR|O_CREAT|O_TRUNC, 0644);
+	
+	if(led_output->fd < 0){
+		perror(led_output->target);
+		return EXIT_FAILURE;
+	}
+	
+	led_output->buf_size = sizeof(led_log_hdr_t)+LED_LOG_NB_RECORDS*record_size;
+	
+	if(ftruncate(led_output->fd, led_output->buf_size) < 0){
+		perror("LED frame log");
+		close(led_output->fd);
+		return EXIT_FAILURE;
+	}
+	
+	led_output->buf = (char*)mmap(NULL, led_output->buf_size, PROT_READ|PROT_WRITE, MAP_SHARED, led_output->fd, 0);
+	
+	if(led_output->buf == MAP_FAILED){
+		perror("LED frame log");
+		led_output->buf = NULL;
+		close(led_output->fd);
+		return EXIT_FAILURE;
+	}
+	
+	hdr = (led_log_hdr_t*)led_output->buf;
+	hdr->magic = LED_LOG_MAGIC;
+	hdr->version = LED_LOG_VERSION;
+	hdr->frame_size = led_output->frame_size;
+	hdr->nb_records = LED_LOG_NB_RECORDS;
+	hdr->nb_frames = 0;
+	
+	led_output->nb_frames = 0;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int file_led_output_write(void *param, const void *frame, size_t size)
+ * @brief log the frame with its time, over the oldest record
+ * @param param, reference to the LED output
+ * @param frame, frame to send
+ * @param size, size of the frame, at most the frame size of the output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int file_led_output_write(void *param, const void *frame, size_t size){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	led_log_hdr_t* hdr = (led_log_hdr_t*)led_output->buf;
+	size_t record_size = LED_LOG_RECORD_SIZE(led_output->frame_size);
+	char* record;
+	struct timespec now;
+	uint64_t time_ns;
+	
+	if(size > led_output->frame_size){
+		return EXIT_FAILURE;
+	}
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	time_ns = (uint64_t)now.tv_sec*1000000000ULL+now.tv_nsec;
+	
+	record = led_output->buf+sizeof(led_log_hdr_t)+(led_output->nb_frames%LED_LOG_NB_RECORDS)*record_size;
+	memcpy(record, &time_ns, sizeof(time_ns));
+	memcpy(record+sizeof(time_ns), frame, size);
+	
+	led_output->nb_frames++;
+	hdr->nb_frames = led_output->nb_frames;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int file_led_output_close(void *param)
+ * @brief unmap and close the log file
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS
+ */
+int file_led_output_close(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	munmap(led_output->buf, led_output->buf_size);
+	led_output->buf = NULL;
+	close(led_output->fd);
+	led_output->fd = -1;
+	
+	return EXIT_SUCCESS;
+}
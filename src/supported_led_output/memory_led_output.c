@@ -0,0 +1,98 @@
+/**
+ * @file memory_led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief LED output to a ring of frames in memory, such that the last frames
+ *        sent can be inspected, as in tests/test_led_writer.c.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_led_output.h"
+
+/*operations of the memory backend*/
+const led_output_ops_t memory_led_output_ops = {
+	.name = "MEMORY",
+	.open = &memory_led_output_open,
+	.write = &memory_led_output_write,
+	.close = &memory_led_output_close,
+	.prefix_updates = 0
+};
+
+/**
+ * int memory_led_output_open(void *param)
+ * @brief allocate the ring of frames
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int memory_led_output_open(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	led_output->buf_size = LED_MEMORY_NB_FRAMES*led_output->frame_size;
+	led_output->buf = (char*)calloc(LED_MEMORY_NB_FRAMES, led_output->frame_size);
+	
+	if(led_output->buf == NULL){
+		perror("LED memory output");
+		return EXIT_FAILURE;
+	}
+	
+	led_output->nb_frames = 0;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int memory_led_output_write(void *param, const void *frame, size_t size)
+ * @brief copy the frame in the ring, over the oldest one
+ * @param param, reference to the LED output
+ * @param frame, frame to send
+ * @param size, size of the frame, at most the frame size of the output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int memory_led_output_write(void *param, const void *frame, size_t size){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	if(size > led_output->frame_size){
+		return EXIT_FAILURE;
+	}
+	
+	memcpy(led_output->buf+(led_output->nb_frames%LED_MEMORY_NB_FRAMES)*led_output->frame_size, frame, size);
+	led_output->nb_frames++;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int memory_led_output_close(void *param)
+ * @brief free the ring of frames
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS
+ */
+int memory_led_output_close(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	free(led_output->buf);
+	led_output->buf = NULL;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * const void* memory_led_output_frame(const led_output_t* led_output, unsigned long frame_nb)
+ * @brief get a frame kept in the ring
+ * @param led_output, reference to the LED output
+ * @param frame_nb, number of the frame, counted from the first one written
+ * @return reference to the frame, NULL if it isn't in the ring
+ */
+const void* memory_led_output_frame(const led_output_t* led_output, unsigned long frame_nb){
+	
+	if(led_output->buf == NULL || frame_nb >= led_output->nb_frames ||
+	   led_output->nb_frames-frame_nb > LED_MEMORY_NB_FRAMES){
+		return NULL;
+	}
+	
+	return led_output->buf+(frame_nb%LED_MEMORY_NB_FRAMES)*led_output->frame_size;
+}
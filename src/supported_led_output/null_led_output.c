@@ -0,0 +1,56 @@
+/**
+ * @file null_led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief LED output that discards the frames, to run and profile the renderer
+ *        without a LED strip.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "null_led_output.h"
+
+/*operations of the null backend*/
+const led_output_ops_t null_led_output_ops = {
+	.name = "NULL",
+	.open = &null_led_output_open,
+	.write = &null_led_output_write,
+	.close = &null_led_output_close,
+	.prefix_updates = 0
+};
+
+/**
+ * int null_led_output_open(void *param)
+ * @brief nothing to open
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS
+ */
+int null_led_output_open(void *param __attribute__((unused))){
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int null_led_output_write(void *param, const void *frame, size_t size)
+ * @brief count the frame and discard it
+ * @param param, reference to the LED output
+ * @param frame, frame to send
+ * @param size, size of the frame
+ * @return EXIT_SUCCESS
+ */
+int null_led_output_write(void *param, const void *frame __attribute__((unused)), size_t size __attribute__((unused))){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	led_output->nb_frames++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int null_led_output_close(void *param)
+ * @brief nothing to close
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS
+ */
+int null_led_output_close(void *param __attribute__((unused))){
+	return EXIT_SUCCESS;
+}
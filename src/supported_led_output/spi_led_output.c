@@ -0,0 +1,95 @@
+/**
+ * @file spi_led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief LED output to the spidev driver, the LED strip of the game.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/types.h>
+#include <linux/spi/spidev.h>
+
+#include "spi_led_output.h"
+
+/*operations of the spidev backend*/
+const led_output_ops_t spi_led_output_ops = {
+	.name = "SPI",
+	.open = &spi_led_output_open,
+	.write = &spi_led_output_write,
+	.close = &spi_led_output_close,
+	.prefix_updates = 1
+};
+
+/**
+ * int spi_led_output_open(void *param)
+ * @brief open the spidev device and set its clock
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int spi_led_output_open(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	led_output->fd = open(led_output->target, O_RDWR);
+	
+	if(led_output->fd < 0){
+		perror(led_output->target);
+		return EXIT_FAILURE;
+	}
+	
+	if(ioctl(led_output->fd, SPI_IOC_WR_MAX_SPEED_HZ, &(led_output->speed_hz)) < 0){
+		perror("SPI clock");
+		close(led_output->fd);
+		led_output->fd = -1;
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int spi_led_output_write(void *param, const void *frame, size_t size)
+ * @brief send a frame in a single SPI transfer
+ * @param param, reference to the LED output
+ * @param frame, frame to send
+ * @param size, size of the frame
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int spi_led_output_write(void *param, const void *frame, size_t size){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	struct spi_ioc_transfer transfer;
+	
+	memset(&transfer, 0, sizeof(transfer));
+	transfer.tx_buf = (unsigned long)frame;
+	transfer.len = size;
+	transfer.speed_hz = led_output->speed_hz;
+	transfer.bits_per_word = 8;
+	
+	if(ioctl(led_output->fd, SPI_IOC_MESSAGE(1), &transfer) < 0){
+		return EXIT_FAILURE;
+	}
+	
+	led_output->nb_frames++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int spi_led_output_close(void *param)
+ * @brief close the spidev device
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int spi_led_output_close(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	close(led_output->fd);
+	led_output->fd = -1;
+	
+	return EXIT_SUCCESS;
+}
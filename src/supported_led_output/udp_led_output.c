@@ -0,0 +1,157 @@
+/**
+ * @file udp_led_output.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief LED output to a networked pixel controller, each frame is sent in
+ * datagrams of at most UDP_LED_MAX_PAYLOAD bytes, see udp_led_output.h.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "udp_led_output.h"
+
+/*operations of the UDP backend*/
+const led_output_ops_t udp_led_output_ops = {
+	.name = "UDP",
+	.open = &udp_led_output_open,
+	.write = &udp_led_output_write,
+	.close = &udp_led_output_close,
+	.prefix_updates = 0
+};
+
+/**
+ * int udp_led_output_open(void *param)
+ * @brief resolve the target, host:port, and connect a datagram socket to it
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int udp_led_output_open(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	char host[LED_OUTPUT_TARGET_LENGTH];
+	char* port;
+	struct addrinfo hints;
+	struct addrinfo* addr;
+	struct addrinfo* cur;
+	int res;
+	
+	/*split host and port*/
+	strcpy(host, led_output->target);
+	port = strrchr(host, ':');
+	
+	if(port == NULL){
+		fprintf(stderr, "LED UDP output, host:port expected: %s\n", led_output->target);
+		return EXIT_FAILURE;
+	}
+	*port = '\0';
+	port++;
+	
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	
+	res = getaddrinfo(host, port, &hints, &addr);
+	if(res != 0){
+		fprintf(stderr, "LED UDP output, %s: %s\n", led_output->target, gai_strerror(res));
+		return EXIT_FAILURE;
+	}
+	
+	/*take the first address that connects*/
+	led_output->fd = -1;
+	for(cur=addr;cur!=NULL;cur=cur->ai_next){
+		
+		led_output->fd = socket(cur->ai_family, cur->ai_socktype, cur->ai_protocol);
+		if(led_output->fd < 0){
+			continue;
+		}
+		
+		if(connect(led_output->fd, cur->ai_addr, cur->ai_addrlen) == 0){
+			break;
+		}
+		
+		close(led_output->fd);
+		led_output->fd = -1;
+	}
+	freeaddrinfo(addr);
+	
+	if(led_output->fd < 0){
+		fprintf(stderr, "LED UDP output, can't connect to %s\n", led_output->target);
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int udp_led_output_write(void *param, const void *frame, size_t size)
+ * @brief send the frame, split in datagrams with their header
+ * @param param, reference to the LED output
+ * @param frame, frame to send
+ * @param size, size of the frame
+ * @return EXIT_SUCCESS, also if the frame is lost, EXIT_FAILURE if the socket is unusable
+ */
+int udp_led_output_write(void *param, const void *frame, size_t size){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	uint32_t header[UDP_LED_HEADER_SIZE/sizeof(uint32_t)];
+	struct iovec iov[2];
+	struct msghdr msg;
+	size_t offset;
+	size_t length;
+	
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+	iov[0].iov_base = header;
+	iov[0].iov_len = UDP_LED_HEADER_SIZE;
+	
+	header[0] = htonl((uint32_t)led_output->nb_frames);
+	header[2] = htonl((uint32_t)size);
+	
+	for(offset=0;offset<size;offset+=length){
+		
+		length = size-offset<UDP_LED_MAX_PAYLOAD?size-offset:UDP_LED_MAX_PAYLOAD;
+		header[1] = htonl((uint32_t)offset);
+		iov[1].iov_base = (char*)frame+offset;
+		iov[1].iov_len = length;
+		
+		if(sendmsg(led_output->fd, &msg, 0) < 0){
+			
+			/*the controller isn't listening (yet) or the network is congested or
+			  down for a moment, the frame is lost and the next one replaces it*/
+			if(errno == ECONNREFUSED || errno == ENOBUFS || errno == EAGAIN || errno == EINTR ||
+			   errno == EHOSTUNREACH || errno == ENETUNREACH || errno == ENETDOWN){
+				break;
+			}
+			return EXIT_FAILURE;
+		}
+	}
+	
+	/*numbers the frames, also the ones lost*/
+	led_output->nb_frames++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int udp_led_output_close(void *param)
+ * @brief close the socket
+ * @param param, reference to the LED output
+ * @return EXIT_SUCCESS
+ */
+int udp_led_output_close(void *param){
+	
+	led_output_t* led_output = (led_output_t*)param;
+	
+	close(led_output->fd);
+	led_output->fd = -1;
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file tick_scheduler.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Fixed-rate tick scheduler, it sleeps with clock_nanosleep on absolute 
+ * deadlines of the monotonic clock. Wall time is used for the phases of the game,
+ * instead of the processor time. Loops that idle at a low rate sleep on a futex
+ * word instead, with the deadline as timeout, such that an event starts the 
+ * next tick right away.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "tick_scheduler.h"
+
+/**
+ * int tick_scheduler_init(tick_scheduler_t* sched, double rate_hz)
+ * @brief initialize the scheduler, the first tick starts now
+ * @param sched, reference to the scheduler
+ * @param rate_hz, tick rate
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int tick_scheduler_init(tick_scheduler_t* sched, double rate_hz){
+	
+	if(rate_hz <= 0){
+		fprintf(stderr, "Invalid tick rate: %.1f Hz\n", rate_hz);
+		return EXIT_FAILURE;
+	}
+	
+	sched->period_ns = (long)(1e9/rate_hz);
+	
+	clock_gettime(CLOCK_MONOTONIC, &(sched->start));
+	sched->tick_start = sched->start;
+	sched->next = sched->start;
+	timespec_add_ns(&(sched->next), sched->period_ns);
+	
+	sched->nb_ticks = 1;
+	sched->nb_events = 0;
+	sched->nb_overruns = 0;
+	sched->nb_skipped = 0;
+	sched->max_work_ns = 0;
+	sched->total_work_ns = 0.0;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int tick_scheduler_wait(tick_scheduler_t* sched)
+ * @brief ends the current tick and sleeps until the next one. If the tick went
+ *        over its deadline, the next tick starts right away and the missed 
+ *        deadlines are skipped, instead of running a burst of late ticks.
+ * @param sched, reference to the scheduler
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int tick_scheduler_wait(tick_scheduler_t* sched){
+	return tick_scheduler_wait_on(sched, NULL, 0);
+}
+
+/**
+ * int tick_scheduler_wait_on(tick_scheduler_t* sched, uint32_t* word, uint32_t expected)
+ * @brief same as tick_scheduler_wait, but the sleep is cut short when the futex
+ *        word is woken, or doesn't hold the expected value anymore. The next tick
+ *        then starts right away and the following deadlines are realigned on it.
+ * @param sched, reference to the scheduler
+ * @param word, futex word private to the process, NULL to only wait for the deadline
+ * @param expected, value of the word while there is no event
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int tick_scheduler_wait_on(tick_scheduler_t* sched, uint32_t* word, uint32_t expected){
+	
+	struct timespec now;
+	long long work_ns;
+	long long late_ns;
+	int res;
+	
+	/*account for the work done in this tick*/
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	work_ns = timespec_diff_ns(&now, &(sched->tick_start));
+	sched->total_work_ns += work_ns;
+	if(work_ns > sched->max_work_ns){
+		sched->max_work_ns = work_ns;
+	}
+	
+	late_ns = timespec_diff_ns(&now, &(sched->next));
+	
+	if(late_ns >= 0){
+		/*overrun, realign on the next deadline still ahead*/
+		sched->nb_overruns++;
+		sched->nb_skipped += late_ns/sched->period_ns;
+		timespec_add_ns(&(sched->next), (late_ns/sched->period_ns)*sched->period_ns);
+	}else if(word != NULL){
+		/*absolute timeout on the monotonic clock*/
+		while((res = syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, expected, &(sched->next), NULL,
+							  FUTEX_BITSET_MATCH_ANY)) != 0 && errno == EINTR);
+		if(res != 0 && errno != ETIMEDOUT && errno != EAGAIN){
+			return EXIT_FAILURE;
+		}
+		
+		/*an event, the tick starts now*/
+		if(res == 0 || errno == EAGAIN){
+			sched->nb_events++;
+			clock_gettime(CLOCK_MONOTONIC, &(sched->next));
+		}
+	}else{
+		while((res = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &(sched->next), NULL)) == EINTR);
+		if(res != 0){
+			return EXIT_FAILURE;
+		}
+	}
+	
+	clock_gettime(CLOCK_MONOTONIC, &(sched->tick_start));
+	timespec_add_ns(&(sched->next), sched->period_ns);
+	sched->nb_ticks++;
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * int tick_scheduler_set_rate(tick_scheduler_t* sched, double rate_hz)
+ * @brief change the tick rate, from the thread of the loop. The next tick is
+ *        one period of the new rate from now.
+ * @param sched, reference to the scheduler
+ * @param rate_hz, tick rate
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+int tick_scheduler_set_rate(tick_scheduler_t* sched, double rate_hz){
+	
+	if(rate_hz <= 0){
+		fprintf(stderr, "Invalid tick rate: %.1f Hz\n", rate_hz);
+		return EXIT_FAILURE;
+	}
+	
+	sched->period_ns = (long)(1e9/rate_hz);
+	clock_gettime(CLOCK_MONOTONIC, &(sched->next));
+	timespec_add_ns(&(sched->next), sched->period_ns);
+	
+	return EXIT_SUCCESS;
+}
+
+/**
+ * double tick_scheduler_elapsed(tick_scheduler_t* sched)
+ * @brief wall time since the scheduler was initialized, at the start of the current tick
+ * @param sched, reference to the scheduler
+ * @return elapsed time in seconds
+ */
+double tick_scheduler_elapsed(tick_scheduler_t* sched){
+	return (double)timespec_diff_ns(&(sched->tick_start), &(sched->start))/1e9;
+}
+
+/**
+ * void tick_scheduler_report(tick_scheduler_t* sched, const char* name)
+ * @brief print the scheduler statistics
+ * @param sched, reference to the scheduler
+ * @param name, name of the scheduled loop
+ */
+void tick_scheduler_report(tick_scheduler_t* sched, const char* name){
+	
+	double avg_work_ns = sched->total_work_ns/(double)sched->nb_ticks;
+	
+	printf("%s: %lu ticks, %lu started by an event, %lu overruns, %lu skipped\n", name, sched->nb_ticks,
+		   sched->nb_events, sched->nb_overruns, sched->nb_skipped);
+	printf("%s: work per tick %.3f ms avg, %.3f ms max, budget %.3f ms\n", name,
+		   avg_work_ns/1e6, (double)sched->max_work_ns/1e6, (double)sched->period_ns/1e6);
+}
+
+/**
+ * void timespec_add_ns(struct timespec* t, long long ns)
+ * @brief add a duration to a time
+ * @param t, time to update
+ * @param ns, duration in nanoseconds, negative to subtract it
+ */
+void timespec_add_ns(struct timespec* t, long long ns){
+	
+	t->tv_sec += (time_t)(ns/1000000000LL);
+	t->tv_nsec += (long)(ns%1000000000LL);
+	if(t->tv_nsec >= 1000000000L){
+		t->tv_nsec -= 1000000000L;
+		t->tv_sec++;
+	}else if(t->tv_nsec < 0){
+		t->tv_nsec += 1000000000L;
+		t->tv_sec--;
+	}
+}
+
+/**
+ * long long timespec_diff_ns(const struct timespec* a, const struct timespec* b)
+ * @brief difference between two times
+ * @return a-b, in nanoseconds
+ */
+long long timespec_diff_ns(const struct timespec* a, const struct timespec* b){
+	return (long long)(a->tv_sec - b->tv_sec)*1000000000LL + (a->tv_nsec - b->tv_nsec);
+}
@@ -17,6 +17,12 @@
 
 static int get_app_attributes(ezxml_t app_attribute, appconfig_t * app_info);
 static int sanity_check_app_attributes(ezxml_t app_attribute);
+static char parse_feature_source(const char *txt);
+static char parse_led_output(const char *txt);
+static char parse_led_encoding(const char *txt);
+static void default_led_target(char output, char *target);
+static void get_led_encoding(ezxml_t element, const char *prefix, led_bus_config_t * bus);
+static int get_led_topology(ezxml_t topology, appconfig_t * app_info);
 
 const char *XML_app_elements[] =
     { "debug", "feature_source", "nb_channels", "window_width", "timeseries", "fft", "power_alpha",
@@ -46,6 +52,241 @@ void set_appconfig(appconfig_t * config_obj)
 	config = config_obj;
 }
 
+/**
+ * parse_feature_source(const char *txt)
+ * @brief converts a feature source name to its identifier
+ * @param txt, name of the source (SHM, SHM_RING, FAKE)
+ * @return source identifier, 0 if unknown
+ */
+static char parse_feature_source(const char *txt)
+{
+	if (strcmp(txt, "FAKE") == 0) {
+		return FAKE_INPUT;
+	} else if (strcmp(txt, "SHM") == 0) {
+		return SHM_INPUT;
+	} else if (strcmp(txt, "SHM_RING") == 0) {
+		return SHM_RING_INPUT;
+	}
+	return 0;
+}
+
+/**
+ * parse_led_output(const char *txt)
+ * @brief converts a LED output name to its identifier
+ * @param txt, name of the output (SPI, NULL, MEMORY, FILE, UDP)
+ * @return output identifier, 0 if unknown
+ */
+static char parse_led_output(const char *txt)
+{
+	if (strcmp(txt, "SPI") == 0) {
+		return SPI_LED_OUTPUT;
+	} else if (strcmp(txt, "NULL") == 0) {
+		return NULL_LED_OUTPUT;
+	} else if (strcmp(txt, "MEMORY") == 0) {
+		return MEMORY_LED_OUTPUT;
+	} else if (strcmp(txt, "FILE") == 0) {
+		return FILE_LED_OUTPUT;
+	} else if (strcmp(txt, "UDP") == 0) {
+		return UDP_LED_OUTPUT;
+	}
+	return 0;
+}
+
+/**
+ * parse_led_encoding(const char *txt)
+ * @brief converts a LED encoding name to its identifier
+ * @param txt, name of the encoding (RAW, APA102, WS2812)
+ * @return encoding identifier, 0 if unknown
+ */
+static char parse_led_encoding(const char *txt)
+{
+	if (strcmp(txt, "RAW") == 0) {
+		return RAW_LED_ENCODING;
+	} else if (strcmp(txt, "APA102") == 0) {
+		return APA102_LED_ENCODING;
+	} else if (strcmp(txt, "WS2812") == 0) {
+		return WS2812_LED_ENCODING;
+	}
+	return 0;
+}
+
+/**
+ * get_led_encoding(ezxml_t element, const char *prefix, led_bus_config_t * bus)
+ * @brief parse the optional encoding, gamma and brightness of a bus
+ * @param element, element containing them
+ * @param prefix, prefix of their names
+ * @param (out)bus, bus to configure
+ */
+static void get_led_encoding(ezxml_t element, const char *prefix, led_bus_config_t * bus)
+{
+	char name[MAX_CHAR_FIELD_LENGTH];
+	ezxml_t tmp = NULL;
+
+	snprintf(name, MAX_CHAR_FIELD_LENGTH, "%sencoding", prefix);
+	tmp = ezxml_child(element, name);
+	if (tmp == NULL) {
+		bus->encoding = RAW_LED_ENCODING;
+	} else {
+		bus->encoding = parse_led_encoding(tmp->txt);
+	}
+
+	snprintf(name, MAX_CHAR_FIELD_LENGTH, "%sgamma", prefix);
+	tmp = ezxml_child(element, name);
+	if (tmp == NULL) {
+		bus->gamma = DEFAULT_LED_GAMMA;
+	} else {
+		bus->gamma = atof(tmp->txt);
+	}
+
+	snprintf(name, MAX_CHAR_FIELD_LENGTH, "%sbrightness", prefix);
+	tmp = ezxml_child(element, name);
+	if (tmp == NULL) {
+		bus->brightness = DEFAULT_LED_BRIGHTNESS;
+	} else {
+		bus->brightness = atof(tmp->txt);
+	}
+}
+
+/**
+ * get_led_speed(ezxml_t element, const char *name, led_bus_config_t * bus)
+ * @brief parse the optional speed of a bus, once its encoding is known
+ * @param element, element containing it
+ * @param name, name of the speed
+ * @param (out)bus, bus to configure
+ */
+static void get_led_speed(ezxml_t element, const char *name, led_bus_config_t * bus)
+{
+	ezxml_t tmp = ezxml_child(element, name);
+
+	if (tmp != NULL) {
+		bus->speed_hz = atoi(tmp->txt);
+	} else if (bus->encoding == WS2812_LED_ENCODING) {
+		bus->speed_hz = DEFAULT_WS2812_BUS_SPEED;
+	} else {
+		bus->speed_hz = DEFAULT_LED_BUS_SPEED;
+	}
+}
+
+/**
+ * default_led_target(char output, char *target)
+ * @brief sets the default target of a LED output
+ * @param output, output identifier
+ * @param (out)target, device, file or host:port of the output
+ */
+static void default_led_target(char output, char *target)
+{
+	if (output == FILE_LED_OUTPUT) {
+		strcpy(target, DEFAULT_LED_LOG_FILE);
+	} else if (output == UDP_LED_OUTPUT) {
+		strcpy(target, DEFAULT_LED_UDP_TARGET);
+	} else {
+		strcpy(target, DEFAULT_SPI_DEVICE);
+	}
+}
+
+/**
+ * get_led_topology(ezxml_t topology, appconfig_t * app_info)
+ * @brief parse the buses and the segments of the LED strip. Each bus has an
+ * output, a target, a speed and the encoding of its LEDs, each segment a
+ * length, the index of its bus and its orientation. Segments are listed in the order of the strip and are
+ * placed on their bus in the same order.
+ * @param topology, reference to the led_topology element
+ * @param (out)app_info, contains the buses and segments
+ * @return < 0 for error, 0 for success
+ */
+static int get_led_topology(ezxml_t topology, appconfig_t * app_info)
+{
+	ezxml_t item = NULL;
+	ezxml_t tmp = NULL;
+	led_bus_config_t *bus = NULL;
+	led_segment_config_t *segment = NULL;
+
+	app_info->nb_led_buses = 0;
+	for (item = ezxml_child(topology, "bus"); item != NULL; item = ezxml_next(item)) {
+
+		if (app_info->nb_led_buses >= MAX_LED_BUSES) {
+			printf("led_topology has more than %d buses\n", MAX_LED_BUSES);
+			return (-1);
+		}
+		bus = &(app_info->led_bus[app_info->nb_led_buses]);
+
+		tmp = ezxml_child(item, "output");
+		if (tmp == NULL) {
+			printf("led_topology->bus->output is missing\n");
+			return (-1);
+		}
+		bus->output = parse_led_output(tmp->txt);
+
+		/*target (optional), defaults on the output */
+		tmp = ezxml_child(item, "target");
+		if (tmp == NULL) {
+			default_led_target(bus->output, bus->target);
+		} else {
+			strncpy(bus->target, tmp->txt, MAX_LED_TARGET_LENGTH-1);
+			bus->target[MAX_LED_TARGET_LENGTH-1] = '\0';
+		}
+
+		/*encoding, gamma and brightness (optional) */
+		get_led_encoding(item, "", bus);
+
+		/*speed (optional), defaults on the encoding */
+		get_led_speed(item, "speed", bus);
+
+		app_info->nb_led_buses++;
+	}
+
+	if (app_info->nb_led_buses == 0) {
+		printf("led_topology has no bus\n");
+		return (-1);
+	}
+
+	app_info->nb_led_segments = 0;
+	for (item = ezxml_child(topology, "segment"); item != NULL; item = ezxml_next(item)) {
+
+		if (app_info->nb_led_segments >= MAX_LED_SEGMENTS) {
+			printf("led_topology has more than %d segments\n", MAX_LED_SEGMENTS);
+			return (-1);
+		}
+		segment = &(app_info->led_segment[app_info->nb_led_segments]);
+
+		tmp = ezxml_child(item, "length");
+		if (tmp == NULL) {
+			printf("led_topology->segment->length is missing\n");
+			return (-1);
+		}
+		segment->length = atoi(tmp->txt);
+
+		/*bus and orientation (optional) */
+		tmp = ezxml_child(item, "bus");
+		if (tmp == NULL) {
+			segment->bus = 0;
+		} else {
+			segment->bus = atoi(tmp->txt);
+		}
+
+		if (segment->bus < 0 || segment->bus >= app_info->nb_led_buses) {
+			printf("led_topology->segment->bus %d is not defined\n", segment->bus);
+			return (-1);
+		}
+
+		tmp = ezxml_child(item, "reversed");
+		if (tmp != NULL && strncmp(tmp->txt, "TRUE", 4) == 0) {
+			segment->reversed = 1;
+		} else {
+			segment->reversed = 0;
+		}
+
+		app_info->nb_led_segments++;
+	}
+
+	if (app_info->nb_led_segments == 0) {
+		printf("led_topology has no segment\n");
+		return (-1);
+	}
+
+	return (0);
+}
+
 /**
  * get_app_attributes(ezxml_t app_attribute, app_info_s * app_info)
  * @brief parse menu attributes and defines appconfig struct
@@ -80,12 +321,21 @@ static int get_app_attributes(ezxml_t app_attribute, appconfig_t * app_info)
 		printf("appAttributes->feature_source is missing\n");
 		return (-1);
 	}
-	if (strcmp(tmp->txt, "FAKE") == 0) {
-		app_info->feature_source = FAKE_INPUT;
-	} else if (strcmp(tmp->txt, "SHM") == 0) {
-		app_info->feature_source = SHM_INPUT;
+	app_info->feature_source = parse_feature_source(tmp->txt);
+
+	/*Get appAttributes/player1_source, player2_source (optional) */
+	tmp = ezxml_child(app_attribute, "player1_source");
+	if (tmp == NULL) {
+		app_info->player_source[0] = app_info->feature_source;
 	} else {
-		app_info->feature_source = 0;
+		app_info->player_source[0] = parse_feature_source(tmp->txt);
+	}
+
+	tmp = ezxml_child(app_attribute, "player2_source");
+	if (tmp == NULL) {
+		app_info->player_source[1] = app_info->feature_source;
+	} else {
+		app_info->player_source[1] = parse_feature_source(tmp->txt);
 	}
 
 	/*Get appAttributes/nb_channels */
@@ -191,6 +441,22 @@ static int get_app_attributes(ezxml_t app_attribute, appconfig_t * app_info)
 	}
 	app_info->training_set_size = atoi(tmp->txt);
 
+	/*Get appAttributes/training_min_size (optional) */
+	tmp = ezxml_child(app_attribute, "training_min_size");
+	if (tmp == NULL) {
+		app_info->training_min_size = DEFAULT_TRAINING_MIN_SIZE;
+	} else {
+		app_info->training_min_size = atoi(tmp->txt);
+	}
+
+	/*Get appAttributes/training_tolerance (optional) */
+	tmp = ezxml_child(app_attribute, "training_tolerance");
+	if (tmp == NULL) {
+		app_info->training_tolerance = DEFAULT_TRAINING_TOLERANCE;
+	} else {
+		app_info->training_tolerance = atof(tmp->txt);
+	}
+
 	tmp = ezxml_child(app_attribute, "test_duration");
 	if (tmp == NULL) {
 		printf("appAttributes->test_duration is missing\n");
@@ -205,6 +471,170 @@ static int get_app_attributes(ezxml_t app_attribute, appconfig_t * app_info)
 	}
 	app_info->avg_kernel = atof(tmp->txt);
 
+	/*Get appAttributes/sample_rate (optional) */
+	tmp = ezxml_child(app_attribute, "sample_rate");
+	if (tmp == NULL) {
+		app_info->sample_rate = DEFAULT_SAMPLE_RATE;
+	} else {
+		app_info->sample_rate = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/tick_rate (optional) */
+	tmp = ezxml_child(app_attribute, "tick_rate");
+	if (tmp == NULL) {
+		app_info->tick_rate = DEFAULT_TICK_RATE;
+	} else {
+		app_info->tick_rate = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/integration_period (optional) */
+	tmp = ezxml_child(app_attribute, "integration_period");
+	if (tmp == NULL || atof(tmp->txt) <= 0.0) {
+		/*the explosion wouldn't move without a timestep*/
+		app_info->integration_period = DEFAULT_INTEGRATION_PERIOD;
+	} else {
+		app_info->integration_period = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/integration_gain (optional) */
+	tmp = ezxml_child(app_attribute, "integration_gain");
+	if (tmp == NULL) {
+		app_info->integration_gain = DEFAULT_INTEGRATION_GAIN;
+	} else {
+		app_info->integration_gain = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/calibration_profiles (optional) */
+	tmp = ezxml_child(app_attribute, "calibration_profiles");
+	if (tmp == NULL) {
+		app_info->calibration_profiles[0] = '\0';
+	} else {
+		strncpy(app_info->calibration_profiles, tmp->txt, MAX_CALIB_PROFILE_PATH_LENGTH-1);
+		app_info->calibration_profiles[MAX_CALIB_PROFILE_PATH_LENGTH-1] = '\0';
+	}
+
+	/*Get appAttributes/player1_id, player2_id (optional) */
+	tmp = ezxml_child(app_attribute, "player1_id");
+	if (tmp == NULL) {
+		app_info->player_id[0] = 1;
+	} else {
+		app_info->player_id[0] = strtoul(tmp->txt, NULL, 0);
+	}
+
+	tmp = ezxml_child(app_attribute, "player2_id");
+	if (tmp == NULL) {
+		app_info->player_id[1] = 2;
+	} else {
+		app_info->player_id[1] = strtoul(tmp->txt, NULL, 0);
+	}
+
+	/*Get appAttributes/verification_size (optional) */
+	tmp = ezxml_child(app_attribute, "verification_size");
+	if (tmp == NULL) {
+		app_info->verification_size = DEFAULT_VERIFICATION_SIZE;
+	} else {
+		app_info->verification_size = atoi(tmp->txt);
+	}
+	if (app_info->verification_size < MIN_VERIFICATION_SIZE) {
+		/*the spread is estimated from the samples, a single one would fail every profile*/
+		app_info->verification_size = MIN_VERIFICATION_SIZE;
+	}
+
+	/*Get appAttributes/profile_tolerance (optional) */
+	tmp = ezxml_child(app_attribute, "profile_tolerance");
+	if (tmp == NULL) {
+		app_info->profile_tolerance = DEFAULT_PROFILE_TOLERANCE;
+	} else {
+		app_info->profile_tolerance = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/adaptive_half_life (optional) */
+	tmp = ezxml_child(app_attribute, "adaptive_half_life");
+	if (tmp == NULL) {
+		app_info->adaptive_half_life = DEFAULT_ADAPTIVE_HALF_LIFE;
+	} else {
+		app_info->adaptive_half_life = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/adaptive_gate (optional) */
+	tmp = ezxml_child(app_attribute, "adaptive_gate");
+	if (tmp == NULL) {
+		app_info->adaptive_gate = DEFAULT_ADAPTIVE_GATE;
+	} else {
+		app_info->adaptive_gate = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/adaptive_max_drift (optional) */
+	tmp = ezxml_child(app_attribute, "adaptive_max_drift");
+	if (tmp == NULL) {
+		app_info->adaptive_max_drift = DEFAULT_ADAPTIVE_MAX_DRIFT;
+	} else {
+		app_info->adaptive_max_drift = atof(tmp->txt);
+	}
+
+	/*Get appAttributes/led_topology (optional) */
+	tmp = ezxml_child(app_attribute, "led_topology");
+	if (tmp != NULL) {
+		if (get_led_topology(tmp, app_info) < 0) {
+			return (-1);
+		}
+	} else {
+
+		/*otherwise, a single strip on a single bus */
+		app_info->nb_led_buses = 1;
+		app_info->nb_led_segments = 1;
+		app_info->led_segment[0].bus = 0;
+		app_info->led_segment[0].length = DEFAULT_NB_LEDS;
+		app_info->led_segment[0].reversed = 0;
+
+		/*Get appAttributes/led_output (optional) */
+		tmp = ezxml_child(app_attribute, "led_output");
+		if (tmp == NULL) {
+			app_info->led_bus[0].output = SPI_LED_OUTPUT;
+		} else {
+			app_info->led_bus[0].output = parse_led_output(tmp->txt);
+		}
+
+		/*Get appAttributes/led_output_target (optional), defaults on the output */
+		tmp = ezxml_child(app_attribute, "led_output_target");
+		if (tmp == NULL) {
+			default_led_target(app_info->led_bus[0].output, app_info->led_bus[0].target);
+		} else {
+			strncpy(app_info->led_bus[0].target, tmp->txt, MAX_LED_TARGET_LENGTH-1);
+			app_info->led_bus[0].target[MAX_LED_TARGET_LENGTH-1] = '\0';
+		}
+
+		/*Get appAttributes/led_encoding, led_gamma, led_brightness (optional) */
+		get_led_encoding(app_attribute, "led_", &(app_info->led_bus[0]));
+
+		/*Get appAttributes/led_speed (optional), defaults on the encoding */
+		get_led_speed(app_attribute, "led_speed", &(app_info->led_bus[0]));
+	}
+
+	/*Get appAttributes/led_keep_alive (optional) */
+	tmp = ezxml_child(app_attribute, "led_keep_alive");
+	if (tmp == NULL) {
+		app_info->led_keep_alive = DEFAULT_LED_KEEP_ALIVE;
+	} else {
+		app_info->led_keep_alive = atoi(tmp->txt);
+	}
+
+	/*Get appAttributes/render_lag (optional) */
+	tmp = ezxml_child(app_attribute, "render_lag");
+	if (tmp == NULL) {
+		app_info->render_lag = DEFAULT_RENDER_LAG;
+	} else {
+		app_info->render_lag = atoi(tmp->txt);
+	}
+
+	/*Get appAttributes/seed (optional) */
+	tmp = ezxml_child(app_attribute, "seed");
+	if (tmp == NULL) {
+		app_info->seed = 0;
+	} else {
+		app_info->seed = strtoull(tmp->txt, NULL, 0);
+	}
+
 	return (0);
 }
 
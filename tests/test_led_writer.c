@@ -0,0 +1,298 @@
+/**
+ * @file test_led_writer.c
+ * @author Frederic Simard (fred.simard@atlantsembedded.com)
+ * @brief Test of the LED writer against the memory output. The transfers are
+ *        driven from the test instead of the writer thread, such that the
+ *        frames sent and the counters are deterministic.
+*/
+
+/*the transfer is static to the writer*/
+#include "../src/led_writer.c"
+
+#include "memory_led_output.h"
+#include "xml.h"
+
+#define TEST_NB_LEDS 16
+#define TEST_KEEP_ALIVE_NS 10000000000L /*long enough not to elapse during the test*/
+
+#define CHECK(cond) \
+		do{ \
+			if(!(cond)){ \
+				fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+				nb_failed++; \
+			} \
+		}while(0)
+
+static int nb_failed = 0;
+
+/*memory output keeping the LEDs past the end of a shorter frame*/
+static const led_output_ops_t prefix_memory_led_output_ops = {
+	.name = "MEMORY prefix",
+	.open = &memory_led_output_open,
+	.write = &memory_led_output_write,
+	.close = &memory_led_output_close,
+	.prefix_updates = 1
+};
+
+/**
+ * int open_test_writer(led_writer_t* writer, led_output_t* led_output, const led_output_ops_t* ops, const led_encoder_t* led_encoder)
+ * @brief set up the writer as start_led_writer does, without its thread
+ * @param writer, reference to the writer
+ * @param led_output, LED output to open
+ * @param ops, backend of the LED output
+ * @param led_encoder, initialized encoder
+ * @return EXIT_SUCCESS, EXIT_FAILURE
+ */
+static int open_test_writer(led_writer_t* writer, led_output_t* led_output, const led_output_ops_t* ops, const led_encoder_t* led_encoder){
+	
+	pixel_t* block;
+	int i;
+	
+	memset(writer, 0, sizeof(led_writer_t));
+	memset(led_output, 0, sizeof(led_output_t));
+	led_output->ops = ops;
+	led_output->fd = -1;
+	led_output->keep_alive_ns = TEST_KEEP_ALIVE_NS;
+	led_output->frame_size = led_encoder_size(led_encoder, TEST_NB_LEDS);
+	
+	block = (pixel_t*)calloc((LED_WRITER_NB_FRAMES+1)*TEST_NB_LEDS, sizeof(pixel_t));
+	writer->wire = (uint8_t*)malloc(led_output->frame_size);
+	if(block == NULL || writer->wire == NULL){
+		perror("LED writer test");
+		return EXIT_FAILURE;
+	}
+	for(i=0;i<LED_WRITER_NB_FRAMES;i++){
+		writer->frames[i] = block+i*TEST_NB_LEDS;
+	}
+	writer->sent = block+LED_WRITER_NB_FRAMES*TEST_NB_LEDS;
+	writer->nb_leds = TEST_NB_LEDS;
+	writer->back = 0;
+	writer->latest = 1;
+	writer->front = 2;
+	writer->led_output = led_output;
+	writer->led_encoder = led_encoder;
+	
+	return OPEN_LED_OUTPUT_FC(led_output);
+}
+
+/**
+ * void close_test_writer(led_writer_t* writer)
+ * @brief close the LED output and free the frames
+ * @param writer, reference to the writer
+ */
+static void close_test_writer(led_writer_t* writer){
+	
+	CLOSE_LED_OUTPUT_FC(writer->led_output);
+	free(writer->frames[0]);
+	free(writer->wire);
+}
+
+/**
+ * void fill_frame(pixel_t* frame, int seed)
+ * @brief render a distinct pattern for each seed
+ * @param (out)frame, frame of TEST_NB_LEDS pixels
+ * @param seed, pattern
+ */
+static void fill_frame(pixel_t* frame, int seed){
+	
+	int i;
+	
+	for(i=0;i<TEST_NB_LEDS;i++){
+		frame[i].red = (uint8_t)(seed*31+i);
+		frame[i].green = (uint8_t)(seed*17+2*i);
+		frame[i].blue = (uint8_t)(seed*7+3*i);
+	}
+}
+
+/**
+ * int frame_sent(const led_writer_t* writer, unsigned long frame_nb, const pixel_t* expected, int nb_leds)
+ * @brief compare a frame of the memory output with the encoding of the first LEDs of a frame
+ * @param writer, reference to the writer
+ * @param frame_nb, number of the frame written to the output
+ * @param expected, frame rendered
+ * @param nb_leds, number of LEDs expected on the wire
+ * @return 1 if the frame matches, 0 otherwise
+ */
+static int frame_sent(const led_writer_t* writer, unsigned long frame_nb, const pixel_t* expected, int nb_leds){
+	
+	uint8_t wire[TEST_NB_LEDS*sizeof(pixel_t)*WS2812_CODE_SIZE+WS2812_RESET_SIZE];
+	const void* frame;
+	size_t size;
+	
+	frame = memory_led_output_frame(writer->led_output, frame_nb);
+	if(frame == NULL){
+		return 0;
+	}
+	size = LED_ENCODE_FC(writer->led_encoder, expected, nb_leds, wire);
+	
+	return memcmp(frame, wire, size) == 0;
+}
+
+/**
+ * void test_keep_alive(const led_encoder_t* led_encoder)
+ * @brief an unchanged frame is only sent once the keep-alive is due, and
+ *        an output without prefix updates gets every frame in full
+ * @param led_encoder, initialized encoder
+ */
+static void test_keep_alive(const led_encoder_t* led_encoder){
+	
+	led_writer_t writer;
+	led_output_t led_output;
+	pixel_t expected[TEST_NB_LEDS];
+	size_t full_size;
+	
+	if(open_test_writer(&writer, &led_output, &memory_led_output_ops, led_encoder) == EXIT_FAILURE){
+		nb_failed++;
+		return;
+	}
+	full_size = led_output.frame_size;
+	
+	/*the first frame is always sent*/
+	fill_frame(expected, 1);
+	fill_frame(led_writer_back(&writer), 1);
+	led_writer_swap(&writer);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_sent == 1 && led_output.nb_frames == 1);
+	CHECK(frame_sent(&writer, 0, expected, TEST_NB_LEDS));
+	
+	/*no new frame, the strip already shows it*/
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_repeated == 1 && writer.nb_unchanged == 1);
+	CHECK(writer.nb_sent == 1 && led_output.nb_frames == 1);
+	
+	/*a new frame identical to what the strip shows*/
+	fill_frame(led_writer_back(&writer), 1);
+	led_writer_swap(&writer);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_repeated == 1 && writer.nb_unchanged == 2);
+	CHECK(led_output.nb_frames == 1);
+	
+	/*the keep-alive is due, the whole frame is sent again*/
+	writer.last_sent.tv_sec -= TEST_KEEP_ALIVE_NS/1000000000L+1;
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_sent == 2 && led_output.nb_frames == 2);
+	CHECK(frame_sent(&writer, 1, expected, TEST_NB_LEDS));
+	
+	/*a single LED changed, the output doesn't keep the others*/
+	fill_frame(led_writer_back(&writer), 1);
+	led_writer_back(&writer)[3].red ^= 0xFF;
+	expected[3].red ^= 0xFF;
+	led_writer_swap(&writer);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_sent == 3 && led_output.nb_frames == 3);
+	CHECK(writer.total_bytes == 3.0*full_size);
+	CHECK(frame_sent(&writer, 2, expected, TEST_NB_LEDS));
+	
+	close_test_writer(&writer);
+}
+
+/**
+ * void test_prefix_updates(const led_encoder_t* led_encoder)
+ * @brief on an output keeping the LEDs past the end of the frame, the frame
+ *        is cut after its last LED that changed
+ * @param led_encoder, initialized encoder
+ */
+static void test_prefix_updates(const led_encoder_t* led_encoder){
+	
+	led_writer_t writer;
+	led_output_t led_output;
+	pixel_t expected[TEST_NB_LEDS];
+	size_t full_size;
+	
+	if(open_test_writer(&writer, &led_output, &prefix_memory_led_output_ops, led_encoder) == EXIT_FAILURE){
+		nb_failed++;
+		return;
+	}
+	full_size = led_output.frame_size;
+	
+	/*the first frame is sent in full*/
+	fill_frame(led_writer_back(&writer), 2);
+	led_writer_swap(&writer);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.total_bytes == (double)full_size);
+	
+	/*LEDs 2 to 4 changed, the frame stops after LED 4*/
+	fill_frame(expected, 2);
+	expected[2].green ^= 0xFF;
+	expected[4].blue ^= 0xFF;
+	memcpy(led_writer_back(&writer), expected, sizeof(expected));
+	led_writer_swap(&writer);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(writer.nb_sent == 2 && led_output.nb_frames == 2);
+	CHECK(writer.total_bytes == (double)(full_size+led_encoder_size(led_encoder, 5)));
+	CHECK(frame_sent(&writer, 1, expected, 5));
+	
+	/*what the strip shows includes the LEDs updated*/
+	CHECK(memcmp(writer.sent, expected, sizeof(expected)) == 0);
+	
+	close_test_writer(&writer);
+}
+
+/**
+ * void test_swap(const led_encoder_t* led_encoder)
+ * @brief the writer sends the latest frame published, the frames replaced
+ *        before a transfer are dropped, and the renderer never gets a frame
+ *        being sent
+ * @param led_encoder, initialized encoder
+ */
+static void test_swap(const led_encoder_t* led_encoder){
+	
+	led_writer_t writer;
+	led_output_t led_output;
+	pixel_t expected[TEST_NB_LEDS];
+	pixel_t* rendered;
+	pixel_t* replaced;
+	
+	if(open_test_writer(&writer, &led_output, &memory_led_output_ops, led_encoder) == EXIT_FAILURE){
+		nb_failed++;
+		return;
+	}
+	
+	/*two frames published before a transfer, the first one is dropped*/
+	replaced = led_writer_back(&writer);
+	fill_frame(replaced, 3);
+	led_writer_swap(&writer);
+	CHECK(led_writer_back(&writer) != replaced);
+	
+	rendered = led_writer_back(&writer);
+	fill_frame(rendered, 4);
+	led_writer_swap(&writer);
+	CHECK(writer.nb_published == 2 && writer.nb_dropped == 1);
+	
+	/*the dropped frame goes back to the renderer*/
+	CHECK(led_writer_back(&writer) == replaced);
+	
+	fill_frame(expected, 4);
+	CHECK(led_writer_send(&writer) == EXIT_SUCCESS);
+	CHECK(frame_sent(&writer, 0, expected, TEST_NB_LEDS));
+	CHECK(writer.frames[writer.front] == rendered);
+	
+	/*once taken, the frame sent is out of the renderer's reach*/
+	led_writer_swap(&writer);
+	CHECK(led_writer_back(&writer) != rendered);
+	led_writer_swap(&writer);
+	CHECK(led_writer_back(&writer) != rendered);
+	CHECK(writer.nb_dropped == 2);
+	
+	close_test_writer(&writer);
+}
+
+int main(){
+	
+	led_encoder_t led_encoder;
+	
+	if(init_led_encoder(RAW_LED_ENCODING, 1.0, 1.0, &led_encoder) == EXIT_FAILURE){
+		return EXIT_FAILURE;
+	}
+	
+	test_keep_alive(&led_encoder);
+	test_prefix_updates(&led_encoder);
+	test_swap(&led_encoder);
+	
+	if(nb_failed > 0){
+		printf("LED writer test: %d checks failed\n", nb_failed);
+		return EXIT_FAILURE;
+	}
+	printf("LED writer test: passed\n");
+	return EXIT_SUCCESS;
+}